@@ -0,0 +1,100 @@
+/*
+baseline_solvers.hpp
+
+Author: Dialo Sall
+
+Known heuristics to measure the Matrix Sorting Machine against, capped at
+three colors and run on the same Graph, so verify_coloring_parallel and the
+exporters work on their results like on run_greedy's
+
+DsaturSolver (Brelaz): always colors the uncolored vertex with the most
+distinct colors among its neighbors (saturation = popcount of
+forbidden_mask), then the most uncolored neighbors (degree - colored_neighbors)
+- Buckets per (saturation, uncolored degree) are doubly-linked lists through
+  the Vertex bucket links, so coloring a vertex moves each uncolored neighbor
+  to its new bucket in O(1); the pick walks down from the highest
+  uncolored degree seen at the highest saturation
+- Colors are tried RED -> BLUE -> YELLOW; a vertex left with every color
+  forbidden is a contradiction, as in run_greedy
+
+RlfSolver (recursive largest first): fills one color at a time
+- The first vertex of a color has the most uncolored neighbors; after that
+  the next vertex is the one with the most neighbors already excluded from
+  this color, then the fewest neighbors still allowed to take it, then lower id
+- A vertex is excluded once a neighbor takes the color; the color is full
+  when no uncolored vertex is left that can take it
+- After RED, BLUE and YELLOW every uncolored vertex has all three colors
+  among its neighbors, and the run fails
+*/
+#ifndef BASELINE_SOLVERS_HPP
+#define BASELINE_SOLVERS_HPP
+
+#include "graph.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace threecolor {
+
+    struct BaselineStats {
+        uint64_t steps;     // vertices colored
+        uint64_t uncolored; // vertices left uncolored when the run ended
+        int contradiction;  // a vertex with every color forbidden, or -1
+    };
+
+    class DsaturSolver {
+    public:
+        explicit DsaturSolver(Graph& g);
+
+        // Same contract as ThreeColorSolver::run_greedy; colors are written to the graph
+        bool run_greedy();
+
+        const BaselineStats& stats() const { return stats_; }
+
+    private:
+        Graph& graph_;
+        BaselineStats stats_;
+        int max_degree_;
+        std::vector<Vertex*> heads_; // bucket (saturation, uncolored degree) at saturation * (max_degree_ + 1) + degree
+        int top_[3];                 // no bucket above this degree is used at each saturation
+
+        int bucket_of(const Vertex* v) const;
+        void insert(Vertex* v);
+        void remove(Vertex* v);
+        Vertex* pick_next_vertex();
+    };
+
+    class RlfSolver {
+    public:
+        explicit RlfSolver(Graph& g);
+
+        // Same contract as ThreeColorSolver::run_greedy; colors are written to the graph
+        bool run_greedy();
+
+        const BaselineStats& stats() const { return stats_; }
+
+    private:
+        struct Candidate {
+            int excluded; // neighbors excluded from the current color
+            int allowed;  // neighbors that may still take it
+            int id;
+
+            bool operator<(const Candidate& other) const;
+        };
+
+        Graph& graph_;
+        BaselineStats stats_;
+
+        std::vector<uint8_t> state_;  // ALLOWED, EXCLUDED or COLORED (for the current color)
+        std::vector<int> excluded_;
+        std::vector<int> allowed_;
+        std::vector<Candidate> heap_; // max-heap; entries whose counts are stale are skipped
+
+        void fill_color(Color c);
+        void take_color(int v, Color c);
+        void push_candidate(int v);
+        int pop_candidate();
+    };
+
+} // namespace threecolor
+
+#endif // BASELINE_SOLVERS_HPP
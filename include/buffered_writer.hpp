@@ -0,0 +1,84 @@
+/*
+buffered_writer.hpp
+
+Author: Dialo Sall
+
+Large-buffer file writer used by the exporters
+- Text and integers are formatted straight into one big buffer
+- The buffer is written out in whole chunks, so a multi-million edge
+  export becomes a few dozen write calls instead of millions of << calls
+*/
+#ifndef BUFFERED_WRITER_HPP
+#define BUFFERED_WRITER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace threecolor {
+
+    class BufferedWriter {
+    public:
+        // Opens path for writing; chunk_size is how many bytes are written per flush
+        explicit BufferedWriter(const std::string& path, size_t chunk_size = 1 << 20);
+        ~BufferedWriter();
+
+        BufferedWriter(const BufferedWriter&) = delete;
+        BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+        void put(char c) {
+            if (size_ == buffer_.size()) flush_chunk();
+            buffer_[size_++] = c;
+        }
+
+        void write(const char* data, size_t len) {
+            if (size_ + len > buffer_.size()) {
+                flush_chunk();
+                if (len > buffer_.size()) {
+                    write_raw(data, len);
+                    return;
+                }
+            }
+            std::memcpy(buffer_.data() + size_, data, len);
+            size_ += len;
+        }
+
+        void write(const char* text) { write(text, std::strlen(text)); }
+
+        // Decimal formatting without going through iostreams
+        void write_int(int64_t value) {
+            if (size_ + 20 > buffer_.size()) flush_chunk();
+            char* out = buffer_.data() + size_;
+            uint64_t mag = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+            char digits[20];
+            int count = 0;
+            do {
+                digits[count++] = static_cast<char>('0' + mag % 10);
+                mag /= 10;
+            } while (mag != 0);
+            if (value < 0) *out++ = '-';
+            while (count > 0) *out++ = digits[--count];
+            size_ = static_cast<size_t>(out - buffer_.data());
+        }
+
+        // Write whatever is buffered and close the file; safe to call twice
+        // Throws std::runtime_error if the last write or fclose fails
+        void close();
+
+        uint64_t bytes_written() const { return bytes_written_ + size_; }
+
+    private:
+        std::FILE* file_;
+        std::vector<char> buffer_;
+        size_t size_;
+        uint64_t bytes_written_;
+
+        void flush_chunk();
+        void write_raw(const char* data, size_t len);
+    };
+
+} // namespace threecolor
+
+#endif // BUFFERED_WRITER_HPP
@@ -0,0 +1,181 @@
+/*
+cdcl_solver.hpp
+
+Author: Dialo Sall
+
+Exact 3-coloring by conflict-driven clause learning (CDCL)
+Unlike the greedy, this search is complete: SATISFIABLE comes with a valid
+coloring and UNSATISFIABLE proves the graph is not 3-colorable
+
+Encoding: boolean x(v,c) = "vertex v has color c" for c in RED/BLUE/YELLOW
+- Domain of v: a forbidden_mask per vertex (bit c set when x(v,c) is false);
+  two bits set forces the third color, three bits set is a conflict
+- Edge u-w: x(u,c) true makes x(w,c) false, read straight from the adjacency
+  instead of storing 3 clauses per edge
+- Learned clauses (nogoods) use two watched literals
+
+Search: VSIDS-like vertex activity seeded by degree, phase saving,
+first-UIP learning, Luby restarts, and periodic learned-clause reduction
+by LBD and activity
+
+Checkpoints (checkpoint.hpp): at a restart, when the writer says one is due,
+and when a limit stops the search, the solver snapshots what a restart keeps:
+the level-0 trail, learned clauses, vertex activity, saved phases, the
+restart schedule and the counters. resume() loads that into a new solver for
+the same graph, which carries on as if it had just restarted
+*/
+#ifndef CDCL_SOLVER_HPP
+#define CDCL_SOLVER_HPP
+
+#include "csr_graph.hpp"
+#include "graph.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace threecolor {
+
+    class CheckpointWriter;
+
+    enum class SolveStatus {
+        SATISFIABLE,   // coloring written to the graph
+        UNSATISFIABLE, // proven not 3-colorable
+        UNKNOWN        // stopped by a limit before deciding
+    };
+
+    const char* solve_status_name(SolveStatus status);
+
+    struct CdclOptions {
+        uint64_t max_conflicts;                        // 0 = no limit
+        std::chrono::steady_clock::time_point deadline; // time_point::max() = no deadline
+        const std::atomic<bool>* stop;                 // set to true from outside to cancel; may be null
+        int restart_base;                              // conflicts per Luby unit
+        int learned_limit;                             // learned clauses kept before the first reduction
+        CheckpointWriter* checkpoint;                  // snapshots of the search; may be null
+
+        CdclOptions()
+            : max_conflicts(0), deadline(std::chrono::steady_clock::time_point::max()),
+              stop(nullptr), restart_base(100), learned_limit(2000), checkpoint(nullptr) {}
+    };
+
+    struct CdclStats {
+        uint64_t decisions;
+        uint64_t propagations;
+        uint64_t conflicts;
+        uint64_t restarts;
+        uint64_t learned;  // clauses learned in total
+        uint64_t deleted;  // learned clauses removed by reduction
+    };
+
+    class CdclSolver {
+    public:
+        explicit CdclSolver(Graph& g, const CdclOptions& options = CdclOptions());
+
+        // Search until a coloring is found, unsatisfiability is proven, or a limit hits
+        // max_conflicts counts the conflicts of resumed runs too
+        SolveStatus solve();
+
+        // Continue from a snapshot of a search on the same graph; call before solve()
+        // Throws std::runtime_error if the snapshot is damaged or for another graph
+        void resume(const std::string& snapshot);
+
+        const CdclStats& stats() const { return stats_; }
+
+    private:
+        // Literal = 2 * var + (1 if negated); var = 3 * vertex + color
+        enum ReasonKind : uint8_t { REASON_NONE, REASON_BINARY, REASON_DOMAIN, REASON_CLAUSE };
+
+        struct Reason {
+            ReasonKind kind;
+            int data; // BINARY: the true literal that implied this one; DOMAIN: vertex; CLAUSE: index
+        };
+
+        struct Clause {
+            std::vector<int> lits;
+            double activity;
+            int lbd;
+            bool deleted;
+        };
+
+        Graph& graph_;
+        CdclOptions options_;
+        CdclStats stats_;
+        int n_;
+
+        CsrGraph adj_;
+
+        // assignment state, indexed by var
+        std::vector<int8_t> value_;   // -1 unassigned, 0 false, 1 true
+        std::vector<int> level_;
+        std::vector<Reason> reason_;
+        std::vector<int> trail_;      // true literals in assignment order
+        std::vector<int> trail_lim_;  // trail size at the start of each decision level
+        size_t qhead_;
+
+        // per-vertex state
+        std::vector<uint8_t> forbidden_mask_; // colors whose literal is false
+        std::vector<int8_t> color_;           // color whose literal is true, or -1
+        std::vector<int8_t> phase_;           // last color held, for phase saving
+        std::vector<double> activity_;
+        double activity_inc_;
+
+        // max-heap of vertices by activity
+        std::vector<int> heap_;
+        std::vector<int> heap_index_;
+
+        std::vector<Clause> clauses_;
+        std::vector<std::vector<int>> watches_; // literal -> clauses watching it
+        std::vector<int> learned_;              // indices of live learned clauses
+        double clause_inc_;
+        int learned_limit_;
+
+        // conflict analysis scratch
+        std::vector<uint8_t> seen_;
+        std::vector<int> conflict_;
+        std::vector<int> learnt_;
+        std::vector<int> lbd_stamp_;
+        int lbd_counter_;
+
+        // restart schedule, kept across checkpoints
+        uint64_t restart_index_;
+        uint64_t conflicts_until_restart_;
+        uint64_t graph_hash_; // fingerprint of adj_ for snapshots, 0 until needed
+
+        static int var_of(int lit) { return lit >> 1; }
+        static int vertex_of_var(int var) { return var / 3; }
+        static int color_of_var(int var) { return var % 3; }
+        static int positive(int vertex, int color) { return 2 * (3 * vertex + color); }
+        static int negate(int lit) { return lit ^ 1; }
+
+        int lit_value(int lit) const {
+            int8_t v = value_[var_of(lit)];
+            return v < 0 ? -1 : (v ^ (lit & 1));
+        }
+        int decision_level() const { return static_cast<int>(trail_lim_.size()); }
+
+        bool enqueue(int lit, Reason why);
+        bool propagate();
+        void analyze(int& backtrack_level);
+        void reason_literals(int var, std::vector<int>& out) const;
+        void backtrack(int level);
+        int pick_decision();
+        void add_learned(const std::vector<int>& lits);
+        void reduce_learned();
+        void write_back();
+        bool out_of_budget() const;
+        void save_checkpoint();
+        uint64_t graph_fingerprint();
+
+        void bump_vertex(int v);
+        void bump_clause(int index);
+        void heap_insert(int v);
+        int heap_pop();
+        void heap_up(int i);
+        void heap_down(int i);
+    };
+
+} // namespace threecolor
+
+#endif // CDCL_SOLVER_HPP
@@ -0,0 +1,198 @@
+/*
+checkpoint.hpp
+
+Author: Dialo Sall
+
+Snapshots of long runs (CDCL searches, benchmark sweeps), so a crash or
+pre-emption only loses the work since the last snapshot
+- The run serializes its state into one of two buffers and hands it to a
+  background thread, then keeps going while the writer puts it on disk
+  (the same double buffering as TraceRecorder)
+- The writer writes path.tmp, fsyncs it, renames it over path and fsyncs
+  the directory, so path always holds one whole snapshot: the old one until
+  the rename, the new one after it. A failed directory fsync counts as a
+  failed write
+- File: a 32-byte header (magic "3CCK", version, kind, payload size,
+  FNV-1a checksum of the payload), then the payload. Values are in host
+  byte order; a snapshot is meant to be resumed on the machine that wrote it
+- Cost is bounded: after a snapshot that took t seconds (serializing on the
+  run's thread plus writing), the next one is not due for
+  t * 100 / max_overhead_percent seconds, and never sooner than interval_seconds.
+  Nor is one due while the cost so far plus t would pass that share of the
+  time since the writer was created. Only a final snapshot, taken whether or not
+  one is due, can go over
+*/
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace threecolor {
+
+    enum class CheckpointKind : uint32_t {
+        CDCL = 1,  // CdclSolver state at a restart
+        SWEEP = 2  // bench sweep progress
+    };
+
+    struct CheckpointHeader {
+        char magic[4];         // "3CCK"
+        uint32_t version;
+        uint32_t kind;         // CheckpointKind
+        uint32_t reserved;
+        uint64_t payload_size;
+        uint64_t checksum;     // FNV-1a of the payload
+    };
+    static_assert(sizeof(CheckpointHeader) == 32, "CheckpointHeader must stay 32 bytes");
+
+    struct CheckpointOptions {
+        double interval_seconds;     // minimum time between snapshots
+        double max_overhead_percent; // snapshot cost as a share of run time; <= 0 means no bound
+
+        CheckpointOptions() : interval_seconds(30.0), max_overhead_percent(1.0) {}
+    };
+
+    struct CheckpointStats {
+        uint64_t snapshots;       // written to disk
+        uint64_t failures;        // writes that failed (the previous snapshot is kept)
+        uint64_t last_bytes;      // size of the last snapshot
+        double serialize_seconds; // on the run's thread
+        double write_seconds;     // in the writer thread, fsync included
+        double run_seconds;       // since the writer was created
+        double overhead_percent;  // (serialize + write) / run time * 100
+    };
+
+    // FNV-1a over a byte range; also used to fingerprint graphs in snapshots
+    uint64_t checkpoint_hash(const void* data, size_t size, uint64_t seed = 1469598103934665603ULL);
+
+    class CheckpointWriter {
+    public:
+        CheckpointWriter(const std::string& path, const CheckpointOptions& options = CheckpointOptions());
+        ~CheckpointWriter();
+
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+        // Cheap check for the run's loop: the interval and the cost budget allow
+        // a snapshot now and the writer is idle
+        bool due();
+
+        // Serializing a snapshot: append the payload to the buffer begin() returns,
+        // then commit() hands it to the writer (waiting only if the previous
+        // snapshot is still being written, e.g. for a final forced one)
+        std::string& begin();
+        void commit(CheckpointKind kind);
+
+        // Wait for the pending write and stop the writer thread; safe to call twice
+        void close();
+
+        // close(), then delete the snapshot: the run finished and needs no resume
+        void discard();
+
+        const std::string& path() const { return path_; }
+        CheckpointStats stats();
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        std::string path_;
+        CheckpointOptions options_;
+        Clock::time_point start_;
+        Clock::time_point serialize_start_;
+
+        std::string buffers_[2];
+        int active_index_;        // buffer the run serializes into
+
+        // Writer thread state, guarded by mutex_
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        int pending_index_;       // buffer waiting to be written, or -1
+        double pending_serialize_;
+        double last_cost_;        // serialize + write time of the last snapshot
+        Clock::time_point next_due_;
+        CheckpointStats stats_;
+        bool stopping_;
+        bool closed_;
+        std::thread writer_;
+
+        void writer_loop();
+    };
+
+    // Reads the snapshot at path into payload (header stripped)
+    // Returns false if there is no file; throws std::runtime_error if it is
+    // damaged or holds another kind of snapshot
+    bool load_checkpoint(const std::string& path, CheckpointKind kind, std::string& payload);
+
+    // Payload helpers: plain values and vectors of plain values, in host byte order
+    template <class T>
+    void put_value(std::string& out, const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "put_value needs a plain type");
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <class T>
+    void put_vector(std::string& out, const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "put_vector needs a plain type");
+        put_value<uint64_t>(out, values.size());
+        out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    inline void put_string(std::string& out, const std::string& value) {
+        put_value<uint64_t>(out, value.size());
+        out.append(value);
+    }
+
+    // Reads what the put_ helpers wrote; throws std::runtime_error past the end
+    class SnapshotReader {
+    public:
+        explicit SnapshotReader(const std::string& data) : data_(data), pos_(0) {}
+
+        template <class T>
+        T get() {
+            static_assert(std::is_trivially_copyable<T>::value, "get needs a plain type");
+            T value;
+            read(&value, sizeof(T));
+            return value;
+        }
+
+        template <class T>
+        std::vector<T> get_vector() {
+            uint64_t size = get<uint64_t>();
+            if (size > (data_.size() - pos_) / sizeof(T)) throw std::runtime_error("Checkpoint is truncated");
+            std::vector<T> values(size);
+            read(values.data(), size * sizeof(T));
+            return values;
+        }
+
+        std::string get_string() {
+            uint64_t size = get<uint64_t>();
+            if (size > data_.size() - pos_) throw std::runtime_error("Checkpoint is truncated");
+            std::string value = data_.substr(pos_, size);
+            pos_ += size;
+            return value;
+        }
+
+        bool at_end() const { return pos_ == data_.size(); }
+
+    private:
+        const std::string& data_;
+        size_t pos_;
+
+        void read(void* out, size_t bytes) {
+            if (bytes > data_.size() - pos_) throw std::runtime_error("Checkpoint is truncated");
+            if (bytes > 0) std::memcpy(out, data_.data() + pos_, bytes);
+            pos_ += bytes;
+        }
+    };
+
+} // namespace threecolor
+
+#endif // CHECKPOINT_HPP
@@ -0,0 +1,79 @@
+/*
+compressed_adjacency.hpp
+
+Author: Dialo Sall
+
+Byte-packed adjacency for graphs whose Neighbor lists do not fit in memory
+- Each row is sorted in descending id order (the order Graph's lists have
+  when edges are added with increasing ids, so solvers make the same choices)
+- A row is stored as its first id, then the gap to each next id, every number
+  as a varint: 7 bits per byte, high bit set when another byte follows
+- Sparse rows with nearby ids need 1-2 bytes per entry instead of the 16-byte
+  Neighbor node (plus allocator overhead) of the linked lists
+
+for_each() decodes a row on the fly; it is defined here so the caller's
+loop body is inlined into the decoder
+*/
+#ifndef COMPRESSED_ADJACENCY_HPP
+#define COMPRESSED_ADJACENCY_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace threecolor {
+
+    class CompressedAdjacency {
+    public:
+        CompressedAdjacency() : row_start_(1, 0) {}
+
+        // From CSR arrays (see CsrGraph): row v is targets[offsets[v], offsets[v + 1]),
+        // sorted ascending without repeats; it is stored reversed
+        CompressedAdjacency(const std::vector<int64_t>& offsets, const std::vector<int>& targets);
+
+        int num_vertices() const { return static_cast<int>(row_start_.size()) - 1; }
+
+        // Bytes held by the encoded rows and the row index
+        uint64_t bytes() const {
+            return data_.size() + row_start_.size() * sizeof(uint64_t);
+        }
+
+        // Calls fn(id) for each neighbor of v, in descending id order, until fn returns false
+        // Returns false if fn stopped the walk
+        template <class Fn>
+        bool for_each(int v, Fn fn) const {
+            const uint8_t* p = data_.data() + row_start_[v];
+            const uint8_t* end = data_.data() + row_start_[v + 1];
+            if (p == end) return true;
+
+            uint32_t id = read_varint(p);
+            if (!fn(static_cast<int>(id))) return false;
+            while (p != end) {
+                id -= read_varint(p);
+                if (!fn(static_cast<int>(id))) return false;
+            }
+            return true;
+        }
+
+    private:
+        std::vector<uint64_t> row_start_; // row v is data_[row_start_[v], row_start_[v + 1])
+        std::vector<uint8_t> data_;
+
+        static uint32_t read_varint(const uint8_t*& p) {
+            uint32_t value = *p & 0x7F;
+            if (*p++ < 0x80) return value;       // one byte: the common case
+            int shift = 7;
+            while (true) {
+                uint8_t byte = *p++;
+                value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                if (byte < 0x80) return value;
+                shift += 7;
+            }
+        }
+
+        static int varint_size(uint32_t value);
+        static uint8_t* write_varint(uint8_t* out, uint32_t value);
+    };
+
+} // namespace threecolor
+
+#endif // COMPRESSED_ADJACENCY_HPP
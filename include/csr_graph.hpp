@@ -0,0 +1,77 @@
+/*
+csr_graph.hpp
+
+Author: Dialo Sall
+
+Compressed sparse row (CSR) adjacency built in bulk from an edge array
+- Every row is sorted by id with duplicates and self-loops removed, so a
+  vertex's degree is the number of distinct neighbors it really has
+- Building runs in parallel, each thread on its own slice of the edges:
+    1. count the entries every slice sends to each block of 2^14 vertices
+    2. prefix sums give each (block, slice) pair its own output range, and
+       both directions of every edge are staged there, grouped by block
+    3. one thread per block counts degrees; a prefix sum gives row offsets
+    4. one thread per block scatters its entries into rows; no atomics,
+       and the block's cursors stay in cache
+    5. sort and unique each row, then compact the rows into the final array
+- to_graph() gives the linked-list Graph the solvers use, with every
+  neighbor list in descending id order (the order add_edge produces when
+  edges are added with increasing ids)
+*/
+#ifndef CSR_GRAPH_HPP
+#define CSR_GRAPH_HPP
+
+#include "graph.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace threecolor {
+
+    struct Edge {
+        int u;
+        int v;
+    };
+
+    // What from_edges dropped from its input
+    struct CsrBuildStats {
+        uint64_t input_edges;
+        uint64_t self_loops;
+        uint64_t duplicate_edges; // undirected copies beyond the first
+    };
+
+    class CsrGraph {
+    public:
+        CsrGraph() : offsets_(1, 0) {}
+
+        // Edges may repeat and appear in either direction; ids must be in [0, n)
+        // Throws std::out_of_range otherwise. threads <= 0 means default_thread_count()
+        static CsrGraph from_edges(int n, const std::vector<Edge>& edges, int threads = 0,
+                                   CsrBuildStats* stats = nullptr);
+
+        // Flat copy of g's Neighbor lists (sorted, duplicates removed)
+        static CsrGraph from_graph(const Graph& g, int threads = 0);
+
+        // Linked-list graph with the same edges and degrees computed
+        Graph to_graph() const;
+
+        int num_vertices() const { return static_cast<int>(offsets_.size()) - 1; }
+        int64_t num_edges() const { return static_cast<int64_t>(targets_.size()) / 2; }
+        int degree(int v) const { return static_cast<int>(offsets_[v + 1] - offsets_[v]); }
+
+        const int* begin(int v) const { return targets_.data() + offsets_[v]; }
+        const int* end(int v) const   { return targets_.data() + offsets_[v + 1]; }
+
+        const std::vector<int64_t>& offsets() const { return offsets_; }
+        const std::vector<int>& targets() const { return targets_; }
+
+    private:
+        std::vector<int64_t> offsets_; // row v is targets_[offsets_[v], offsets_[v + 1])
+        std::vector<int> targets_;
+
+        // Sort and unique every row of a scattered adjacency, then compact it
+        static CsrGraph finish_rows(std::vector<int64_t>& offsets, std::vector<int>& targets, int threads);
+    };
+
+} // namespace threecolor
+
+#endif // CSR_GRAPH_HPP
@@ -0,0 +1,85 @@
+/*
+dense_solver.hpp
+
+Author: Dialo Sall
+
+Bitset version of the greedy for dense graphs
+- Adjacency is one row of 64-bit words per vertex
+- For each color there is one bitset of vertices that may still take it
+- Coloring v with c is allowed[c] &= ~row(v), done a whole word (or an AVX2
+  register of four words) at a time, instead of walking a linked list
+- The AVX2 loop is compiled on every x86 build (target attribute) and picked
+  at run time when the CPU has AVX2, so the default build uses it too
+
+Makes the same choices as the greedy with PropagateTrapped:
+trapped vertices first (most recently trapped first), then highest degree,
+most colored neighbors, lowest id, colors in RED -> BLUE -> YELLOW order.
+Vertices trapped by the same step are queued as if the neighbor list were
+in descending id order, which is the order Graph builds when edges are
+added with increasing ids (generate_random_graph, the edge list loader).
+ThreeColorSolver (ForcedPropagation) reaches the same colorings and the same
+successes; only the step at which a failing run stops can differ.
+*/
+#ifndef DENSE_SOLVER_HPP
+#define DENSE_SOLVER_HPP
+
+#include "graph.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace threecolor {
+
+    class DenseSolver {
+    public:
+        explicit DenseSolver(Graph& g);
+
+        // Same contract as ThreeColorSolver::run_greedy; colors are written back to the graph
+        bool run_greedy();
+
+        // Edge density (2m / n(n-1)) at or above which the dense engine pays off
+        static constexpr double kDensityThreshold = 0.02;
+        // Largest graph the dense engine accepts (n^2 / 8 bytes of adjacency)
+        static constexpr int kMaxVertices = 1 << 15;
+
+        // True if g is dense enough and small enough for this engine
+        static bool prefers_dense(const Graph& g);
+
+        // True if this build has the AVX2 loop and the CPU runs it
+        static bool avx2_available();
+        // Use the AVX2 loop (the default when available) or the plain word loop;
+        // asking for AVX2 where it is not available keeps the word loop
+        void use_avx2(bool on) { use_avx2_ = on && avx2_available(); }
+        bool using_avx2() const { return use_avx2_; }
+
+    private:
+        Graph& graph_;
+        int n_;
+        int words_;                        // 64-bit words per row
+        bool use_avx2_;
+
+        std::vector<uint64_t> adjacency_;  // n_ rows of words_ words
+        std::vector<uint64_t> allowed_[3]; // allowed_[c]: vertices that may still take color c
+        std::vector<uint64_t> uncolored_;
+        std::vector<uint64_t> changed_;    // scratch: neighbors that just lost a color
+
+        std::vector<int8_t> color_;
+        std::vector<int> colored_neighbors_;
+        std::vector<int> order_;           // vertices by degree descending, id ascending
+        int order_start_;                  // every vertex before this in order_ is colored
+
+        std::vector<int> trapped_;         // stack of trapped vertices
+        std::vector<uint8_t> is_trapped_;
+
+        const uint64_t* row(int v) const { return adjacency_.data() + static_cast<size_t>(v) * words_; }
+        bool is_uncolored(int v) const { return (uncolored_[v >> 6] >> (v & 63)) & 1ULL; }
+
+        void initialize_state();
+        int pick_next_vertex();
+        int choose_color(int v) const;
+        bool color_vertex(int v, int c);
+        void write_back();
+    };
+
+} // namespace threecolor
+
+#endif // DENSE_SOLVER_HPP
@@ -0,0 +1,124 @@
+/*
+external_coloring.hpp
+
+Author: Dialo Sall
+
+Semi-external coloring for edge lists bigger than memory
+Only per-vertex state stays in RAM (color, forbidden_mask, a conflict flag,
+the row size and the id mapping: 11 bytes per vertex); the edges live on disk.
+
+build_external_adjacency turns an edge list file (Graph::from_edge_list_file
+format) into a disk adjacency file:
+    1. one pass over the text counts degrees and fixes the processing order:
+       higher degree first, lower id first among equals (the sorting
+       machine's order before any vertex is colored)
+    2. a second pass writes both directions of every edge, renamed to
+       positions in that order, into sorted runs of at most memory_bytes
+    3. the runs are merged into one file of rows in processing order, each
+       row its neighbors' positions ascending, as a first value plus gaps
+       (varints, like CompressedAdjacency); repeats and self-loops are dropped
+    File layout: rows, then row sizes (uint32 bytes per row), then original
+    ids (uint32 per position), then a 32-byte trailer: magic, n, edges, row bytes
+
+ExternalColorer reads that file front to back in large sequential reads:
+    - first pass: each vertex takes the first color not in its forbidden_mask
+      (RED -> BLUE -> YELLOW) and adds it to its uncolored neighbors' masks.
+      The trapped-first rule of run_greedy needs random access, so a vertex
+      with every color forbidden takes the color fewest neighbors use and is
+      marked conflicted instead of stopping the run
+    - repair passes: only the rows of conflicted vertices are read (the rest
+      are skipped with a seek); each one still sharing a color with a
+      neighbor moves to whichever of its other two colors fewer neighbors
+      use (random among equals) and marks the neighbors on its new color.
+      Every same-color edge keeps a marked endpoint, so a pass that ends
+      with nothing marked leaves a valid coloring
+*/
+#ifndef EXTERNAL_COLORING_HPP
+#define EXTERNAL_COLORING_HPP
+
+#include "graph.hpp"
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace threecolor {
+
+    struct ExternalOptions {
+        uint64_t memory_bytes; // budget for the sort runs and the merge buffers
+        size_t read_chunk;     // bytes per sequential read
+        int max_passes;        // repair passes before giving up
+        uint32_t seed;         // random choice between equally good repair colors
+
+        ExternalOptions()
+            : memory_bytes(256ULL << 20), read_chunk(4 << 20), max_passes(200), seed(1) {}
+    };
+
+    struct ExternalIoStats {
+        uint64_t bytes_read;
+        uint64_t bytes_written;
+    };
+
+    struct ExternalBuildStats {
+        uint64_t input_edges;
+        uint64_t self_loops;
+        uint64_t duplicate_edges; // undirected copies beyond the first
+        int sort_runs;
+        ExternalIoStats io;
+    };
+
+    struct ExternalColorStats {
+        int passes;                     // the first pass plus the repair passes
+        uint64_t first_pass_conflicts;  // vertices marked by the first pass
+        uint64_t conflicted;            // vertices still marked at the end
+        ExternalIoStats io;
+    };
+
+    // Sort edge_list_path (text, "n m" then m "u v" lines) into adjacency_path
+    // Temporary runs are written next to adjacency_path and removed afterwards
+    // Throws std::runtime_error on I/O errors, std::out_of_range on bad ids
+    ExternalBuildStats build_external_adjacency(const std::string& edge_list_path,
+                                                const std::string& adjacency_path,
+                                                const ExternalOptions& options = ExternalOptions());
+
+    class ExternalColorer {
+    public:
+        explicit ExternalColorer(const std::string& adjacency_path,
+                                 const ExternalOptions& options = ExternalOptions());
+
+        // Returns true if the passes ended with a valid 3-coloring
+        bool run();
+
+        // One more sequential pass that checks every edge (counted in stats().io)
+        bool verify();
+
+        int num_vertices() const { return n_; }
+        uint64_t num_edges() const { return m_; }
+
+        // Color of a vertex by its id in the edge list
+        Color color(int v) const { return static_cast<Color>(color_[rank_of_[v]]); }
+
+        const ExternalColorStats& stats() const { return stats_; }
+
+    private:
+        std::string path_;
+        ExternalOptions options_;
+        ExternalColorStats stats_;
+        int n_;
+        uint64_t m_;
+        uint64_t row_bytes_total_;
+
+        // indexed by position in the processing order
+        std::vector<int8_t> color_;
+        std::vector<uint8_t> forbidden_mask_;
+        std::vector<uint8_t> conflicted_;
+        std::vector<uint32_t> row_bytes_;
+        std::vector<int> rank_of_; // edge list id -> position
+
+        void first_pass();
+        uint64_t repair_pass(std::vector<int>& row, std::mt19937& rng);
+    };
+
+} // namespace threecolor
+
+#endif // EXTERNAL_COLORING_HPP
@@ -10,6 +10,8 @@ Defines Vertex Structure, Colors for graph, and Neighbor Structure
 #ifndef GRAPH_HPP
 #define GRAPH_HPP
 
+#include "compressed_adjacency.hpp"
+#include <iosfwd>
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -38,13 +40,12 @@ namespace threecolor {
         uint8_t forbidden_mask; // bit i=1 if color i is forbidden
         bool is_trapped; // true if exactly 1 color is available
 
-        // adjacency list
+        // adjacency list (null once the graph is compressed; use Graph::for_each_neighbor)
         Neighbor* neighbors_head;
 
         //links used by SortingMachine buckets
         Vertex* next_in_bucket;
         Vertex* prev_in_bucket;
-        Vertex* next_trapped;
 
         Vertex();
     };
@@ -69,8 +70,31 @@ namespace threecolor {
         const Vertex& vertex(int id) const { return vertices[id]; }
 
         // Add undirected edge u-v
+        // Does not check for an existing u-v edge; build from an edge array with
+        // CsrGraph (csr_graph.hpp) when the input may contain duplicates
+        // Throws std::logic_error once the graph is compressed
         void add_edge(int u, int v);
 
+        // Calls fn(neighbor_id) for each neighbor of v until fn returns false
+        // Returns false if fn stopped the walk
+        template <class Fn>
+        bool for_each_neighbor(int v, Fn fn) const {
+            if (compressed) return adjacency.for_each(v, fn);
+            for (Neighbor* p = vertices[v].neighbors_head; p != nullptr; p = p->next) {
+                if (!fn(p->v->id)) return false;
+            }
+            return true;
+        }
+
+        // Replace the Neighbor lists with a CompressedAdjacency (delta + varint rows)
+        // Duplicate edges are dropped and every row is in descending id order;
+        // the graph can no longer take new edges
+        void compress();
+        bool is_compressed() const { return compressed; }
+
+        // Bytes used by the adjacency: Neighbor nodes, or the compressed rows
+        uint64_t adjacency_bytes() const;
+
         // Compute degree field for each vertex
         void compute_degrees();
 
@@ -78,10 +102,18 @@ namespace threecolor {
         void reset_coloring_state();
 
         // Optional: load graph from simple edge list file
-        static Graph from_edge_list_file(const std::string& path);
+        // Duplicate edges and self-loops in the file are dropped
+        // compressed loads straight into compressed rows, never building the lists
+        static Graph from_edge_list_file(const std::string& path, bool compressed = false);
+
+        // Same format from any stream (e.g. a request held in memory)
+        // Throws std::runtime_error if the text is cut short or malformed
+        static Graph from_edge_list(std::istream& in, bool compressed = false);
 
     private:
         std::vector<Vertex> vertices;
+        CompressedAdjacency adjacency; // used instead of the lists when compressed
+        bool compressed = false;
 
         void clear_neighbors();
     };
@@ -0,0 +1,97 @@
+/*
+parallel.hpp
+
+Author: Dialo Sall
+
+Small threading helpers shared by the parallel passes
+- Work is split into fixed-size chunks handed out through an atomic counter,
+  so threads that land on low-degree vertices just take more chunks
+- The calling thread always does work too; one thread means no thread is spawned
+- parallel_exclusive_scan turns per-vertex counts into CSR offsets
+*/
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace threecolor {
+
+    // Hardware thread count, at least 1
+    inline int default_thread_count() {
+        unsigned hc = std::thread::hardware_concurrency();
+        return hc > 0 ? static_cast<int>(hc) : 1;
+    }
+
+    // Calls fn(thread_index) on num_threads threads and waits for all of them
+    // num_threads <= 0 means default_thread_count()
+    template <class Fn>
+    void run_on_threads(int num_threads, Fn fn) {
+        if (num_threads <= 0) num_threads = default_thread_count();
+
+        std::vector<std::thread> workers;
+        workers.reserve(num_threads - 1);
+        for (int t = 1; t < num_threads; ++t) {
+            workers.emplace_back([&fn, t] { fn(t); });
+        }
+        fn(0);
+        for (auto& w : workers) w.join();
+    }
+
+    // Calls fn(chunk_begin, chunk_end, thread_index) over [begin, end) in chunks
+    template <class Fn>
+    void parallel_for_chunks(int64_t begin, int64_t end, int64_t chunk, int num_threads, Fn fn) {
+        if (end <= begin) return;
+        if (chunk < 1) chunk = 1;
+        if (num_threads <= 0) num_threads = default_thread_count();
+
+        // never start more threads than there are chunks
+        int64_t chunks = (end - begin + chunk - 1) / chunk;
+        num_threads = static_cast<int>(std::min<int64_t>(num_threads, chunks));
+
+        std::atomic<int64_t> next(begin);
+        run_on_threads(num_threads, [&](int t) {
+            while (true) {
+                int64_t b = next.fetch_add(chunk, std::memory_order_relaxed);
+                if (b >= end) break;
+                fn(b, std::min(b + chunk, end), t);
+            }
+        });
+    }
+
+    // out[0] = 0, out[i + 1] = value(0) + ... + value(i) for i in [0, n)
+    // Each thread sums one block, the block totals are scanned serially, then
+    // each thread writes the running sums of its block
+    template <class Fn>
+    void parallel_exclusive_scan(int64_t n, int num_threads, std::vector<int64_t>& out, Fn value) {
+        out.assign(n + 1, 0);
+        if (n <= 0) return;
+        if (num_threads <= 0) num_threads = default_thread_count();
+        num_threads = static_cast<int>(std::min<int64_t>(num_threads, n));
+
+        int64_t block = (n + num_threads - 1) / num_threads;
+        std::vector<int64_t> block_sum(num_threads + 1, 0);
+        run_on_threads(num_threads, [&](int t) {
+            int64_t b = t * block, e = std::min(n, b + block);
+            int64_t sum = 0;
+            for (int64_t i = b; i < e; ++i) sum += value(i);
+            block_sum[t + 1] = sum;
+        });
+        for (int t = 0; t < num_threads; ++t) block_sum[t + 1] += block_sum[t];
+
+        run_on_threads(num_threads, [&](int t) {
+            int64_t b = t * block, e = std::min(n, b + block);
+            int64_t sum = block_sum[t];
+            for (int64_t i = b; i < e; ++i) {
+                sum += value(i);
+                out[i + 1] = sum;
+            }
+        });
+    }
+
+} // namespace threecolor
+
+#endif // PARALLEL_HPP
@@ -0,0 +1,108 @@
+/*
+parallel_greedy.hpp
+
+Author: Dialo Sall
+
+Parallel greedy in rounds (Jones-Plassmann style) for graphs too big for one core
+Every vertex has a priority: trapped vertices first, then degree, then colored
+neighbors, then a random number, then lower id (RANDOM drops the degree).
+Each round:
+    1. Color: uncolored vertices that beat every uncolored vertex within two
+       steps (local maxima) take the first color not in their forbidden_mask,
+       in RED -> BLUE -> YELLOW order. Two steps, so no vertex gets two newly
+       colored neighbors in one round and trapped vertices still go next, as
+       in run_greedy. The second step goes through the two highest priority
+       vertices of each neighbor's neighborhood, ranked once per round, so a
+       round costs O(edges) even around hubs. In speculative mode every
+       uncolored vertex colors
+    2. Detect: two neighbors that picked the same color in this round keep
+       the higher priority one; the other goes back to the next round
+       (plain Jones-Plassmann never produces such a pair)
+    3. Commit: each kept color is OR-ed into the neighbors' forbidden masks
+       with atomic fetch_or, so threads never take a lock
+A vertex with every color forbidden is a contradiction, as in run_greedy
+
+The phases only read state the previous phase finished writing, so the
+coloring depends on the options and the graph, never on the thread count
+*/
+#ifndef PARALLEL_GREEDY_HPP
+#define PARALLEL_GREEDY_HPP
+
+#include "csr_graph.hpp"
+#include "graph.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace threecolor {
+
+    enum class ParallelPriority {
+        DEGREE, // higher degree first, random among equal degrees
+        RANDOM  // random order
+    };
+
+    struct ParallelGreedyOptions {
+        int threads;               // <= 0 means default_thread_count()
+        ParallelPriority priority;
+        bool speculative;          // every uncolored vertex colors each round; conflicts are undone
+        uint64_t seed;             // seed of the random part of the priority
+
+        ParallelGreedyOptions()
+            : threads(0), priority(ParallelPriority::DEGREE), speculative(false), seed(1) {}
+    };
+
+    struct ParallelGreedyStats {
+        uint64_t rounds;
+        uint64_t colored;        // vertices colored when the run ended
+        uint64_t conflicts;      // speculative colors undone by the detect phase
+        int contradiction;       // lowest id of a vertex left with no color, or -1
+    };
+
+    class ParallelGreedySolver {
+    public:
+        explicit ParallelGreedySolver(Graph& g, const ParallelGreedyOptions& options = ParallelGreedyOptions());
+
+        // Returns true if a 3-coloring was found; colors are written back to the graph either way
+        bool run_greedy();
+
+        const ParallelGreedyStats& stats() const { return stats_; }
+
+    private:
+        Graph& graph_;
+        ParallelGreedyOptions options_;
+        ParallelGreedyStats stats_;
+        int n_;
+        int threads_;
+
+        CsrGraph adj_;
+        std::vector<uint64_t> base_priority_;  // degree / random part, fixed for the run
+
+        std::unique_ptr<std::atomic<uint8_t>[]> forbidden_mask_;
+        std::unique_ptr<std::atomic<int>[]> colored_neighbors_;
+        // Highest priority vertex among a vertex and its uncolored neighbors, and
+        // the runner-up (or -1), valid in the round ranked_round_ names
+        std::unique_ptr<std::atomic<uint32_t>[]> ranked_round_;
+        std::unique_ptr<std::atomic<int>[]> best_;
+        std::unique_ptr<std::atomic<int>[]> second_;
+        uint32_t round_;                 // stamp of the current round, from 1
+        std::vector<int8_t> color_;      // tentative until committed
+        std::vector<uint8_t> committed_; // color is final
+        std::vector<uint8_t> picked_;    // colored in the current round
+        std::vector<uint8_t> lost_;      // lost a same-color conflict this round
+
+        std::vector<int> work_;          // uncolored vertices at the start of the round
+        std::vector<std::vector<int>> next_; // per-thread part of the next work list
+
+        // Trapped vertices jump ahead; ties go to the lower id
+        uint64_t priority(int v) const;
+        bool beats(int a, int b) const;
+        void rank_neighborhood(int w, int& best, int& second);
+        bool is_local_max(int v);
+
+        void write_back();
+    };
+
+} // namespace threecolor
+
+#endif // PARALLEL_GREEDY_HPP
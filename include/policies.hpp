@@ -0,0 +1,108 @@
+/*
+policies.hpp
+
+Author: Dialo Sall
+
+Compile-time policies for the greedy solver
+Each policy is a plain type with static members, so a solver instantiated
+with it gets the choice inlined into the inner loop instead of branching on
+a runtime option at every step
+
+Color policies decide which available color a vertex gets:
+    static Color choose(uint8_t forbidden_mask, const int* color_counts)
+    color_counts[c] = vertices colored c so far
+Tie-break policies order vertices with equal degree and colored neighbors:
+    static bool before(const Vertex* a, const Vertex* b)
+Trapped policies decide whether trapped vertices jump the queue:
+    static constexpr bool propagate        trapped vertices are colored before the next pick
+    static constexpr bool fifo             oldest trapped vertex first instead of newest
+    static constexpr bool forced_conflicts adjacent trapped vertices forced to the same
+                                           color fail immediately instead of when colored
+*/
+#ifndef POLICIES_HPP
+#define POLICIES_HPP
+
+#include "graph.hpp"
+#include <cstdint>
+
+namespace threecolor {
+
+    // Fixed priority: first of A, B, C that is not forbidden
+    template <Color A, Color B, Color C>
+    struct FixedColorOrder {
+        static Color choose(uint8_t forbidden, const int*) {
+            if ((forbidden & (1 << A)) == 0) return A;
+            if ((forbidden & (1 << B)) == 0) return B;
+            if ((forbidden & (1 << C)) == 0) return C;
+            return UNCOLORED;
+        }
+    };
+
+    // The original rule: RED, then BLUE, then YELLOW
+    using RedBlueYellow = FixedColorOrder<RED, BLUE, YELLOW>;
+
+    // Available color used by the fewest vertices so far (ties: RED, BLUE, YELLOW)
+    struct LeastUsedColor {
+        static Color choose(uint8_t forbidden, const int* counts) {
+            Color best = UNCOLORED;
+            for (int c = 0; c < 3; ++c) {
+                if ((forbidden & (1 << c)) == 0 && (best == UNCOLORED || counts[c] < counts[best])) {
+                    best = static_cast<Color>(c);
+                }
+            }
+            return best;
+        }
+    };
+
+    // Available color used by the most vertices so far (ties: RED, BLUE, YELLOW)
+    struct MostUsedColor {
+        static Color choose(uint8_t forbidden, const int* counts) {
+            Color best = UNCOLORED;
+            for (int c = 0; c < 3; ++c) {
+                if ((forbidden & (1 << c)) == 0 && (best == UNCOLORED || counts[c] > counts[best])) {
+                    best = static_cast<Color>(c);
+                }
+            }
+            return best;
+        }
+    };
+
+    // The original rule: lower id wins
+    struct LowerIdFirst {
+        static bool before(const Vertex* a, const Vertex* b) { return a->id < b->id; }
+    };
+
+    struct HigherIdFirst {
+        static bool before(const Vertex* a, const Vertex* b) { return a->id > b->id; }
+    };
+
+    // The original rule: trapped vertices are colored before the sorting machine
+    // picks, newest first
+    struct PropagateTrapped {
+        static constexpr bool propagate = true;
+        static constexpr bool fifo = false;
+        static constexpr bool forced_conflicts = false;
+    };
+
+    // Trapped vertices wait for their turn in the sorting machine
+    struct IgnoreTrapped {
+        static constexpr bool propagate = false;
+        static constexpr bool fifo = false;
+        static constexpr bool forced_conflicts = false;
+    };
+
+    // Stronger propagation, and the default (ThreeColorSolver): trapped vertices
+    // are drained in FIFO order before the next pick, and a vertex whose forced
+    // color matches a trapped neighbor's forced color is a contradiction the
+    // moment it becomes trapped. Draining stops only once no vertex is trapped,
+    // so any order reaches the same closure as PropagateTrapped: the same runs
+    // succeed with the same colors, and failing runs stop sooner
+    struct ForcedPropagation {
+        static constexpr bool propagate = true;
+        static constexpr bool fifo = true;
+        static constexpr bool forced_conflicts = true;
+    };
+
+} // namespace threecolor
+
+#endif // POLICIES_HPP
@@ -0,0 +1,183 @@
+/*
+solve_service.hpp
+
+Author: Dialo Sall
+
+Long-running solver service: graphs come in over a Unix-domain socket or
+stdin, colorings go back over the same stream, and nothing touches disk
+- Every message is a frame: uint32 length, then that many bytes
+  (all integers little-endian)
+- Request frame:  uint64 id, uint8 type (SOLVE / CANCEL / SHUTDOWN),
+                  uint8 solver, uint8 format, uint8 reserved, uint32 deadline_ms,
+                  then the graph for SOLVE:
+                      BINARY:    uint32 n, uint32 m, then m pairs of uint32 u, v
+                      EDGE_LIST: the text Graph::from_edge_list_file reads
+                  CANCEL names the request to cancel in id
+- Response frame: uint64 id, uint8 status, uint8[3] reserved, uint32 solve_us,
+                  uint32 size, then size bytes: one color per vertex (0/1/2) for
+                  COLORED, an error message for BAD_REQUEST, nothing otherwise
+
+SolveService queues requests onto a fixed pool of workers:
+    - a request whose deadline passes while queued is answered TIMEOUT
+      without being solved
+    - a running request checks its deadline and stop flag after parsing, after
+      the K4 / odd wheel filter and after a failed greedy that CDCL would follow;
+      the CDCL search also checks them between conflicts. A stage that settles
+      the request answers it. Parsing, the filter (bounded by filter_work_limit)
+      and a greedy run are not interrupted, so a reply can come that much late
+    - CANCEL drops a queued request, or raises the stop flag of a running one
+    - every request gets exactly one response, from the worker thread
+*/
+#ifndef SOLVE_SERVICE_HPP
+#define SOLVE_SERVICE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace threecolor {
+
+    enum class RequestType : uint8_t {
+        SOLVE = 0,
+        CANCEL = 1,
+        SHUTDOWN = 2 // stop accepting connections once running requests are answered
+    };
+
+    enum class ServiceSolver : uint8_t {
+        GREEDY = 0, // run_greedy_with_policy with the default rules
+        CDCL = 1,   // exact search, bounded by the deadline
+        AUTO = 2    // greedy, then CDCL for the time left if the greedy fails
+    };
+
+    enum class PayloadFormat : uint8_t {
+        BINARY = 0,
+        EDGE_LIST = 1
+    };
+
+    enum class ResponseStatus : uint8_t {
+        COLORED = 0,        // colors follow
+        NOT_COLORABLE = 1,  // K4 / odd wheel found, or CDCL proved it
+        FAILED = 2,         // the greedy ran into a contradiction
+        TIMEOUT = 3,
+        CANCELLED = 4,
+        BAD_REQUEST = 5,    // the message explains why
+        BUSY = 6            // queue full
+    };
+
+    const char* response_status_name(ResponseStatus status);
+    ServiceSolver parse_service_solver(const std::string& name); // greedy, cdcl or auto
+
+    struct SolveRequest {
+        uint64_t id;
+        RequestType type;
+        ServiceSolver solver;
+        PayloadFormat format;
+        uint32_t deadline_ms; // 0 = no deadline
+        std::string payload;
+
+        SolveRequest()
+            : id(0), type(RequestType::SOLVE), solver(ServiceSolver::AUTO),
+              format(PayloadFormat::BINARY), deadline_ms(0) {}
+    };
+
+    struct SolveResponse {
+        uint64_t id;
+        ResponseStatus status;
+        uint32_t solve_us;  // time in the worker, parsing included
+        std::string data;   // colors or error message
+    };
+
+    // Frame bodies (without the length prefix)
+    std::string encode_request(const SolveRequest& request);
+    std::string encode_response(const SolveResponse& response);
+    // Return false on a malformed body
+    bool decode_request(const std::string& body, SolveRequest& request);
+    bool decode_response(const std::string& body, SolveResponse& response);
+
+    // BINARY payload for n vertices and the given edges
+    std::string encode_binary_graph(int n, const std::vector<std::pair<int, int>>& edges);
+
+    // Blocking frame I/O on a file descriptor; false at end of stream or on error
+    bool read_frame(int fd, std::string& body);
+    bool write_frame(int fd, const std::string& body);
+
+    struct ServiceOptions {
+        int workers;       // <= 0 means default_thread_count()
+        size_t max_queue;  // queued requests beyond this are answered BUSY
+        uint64_t filter_work_limit; // per search of the K4 / odd wheel filter (UnsatFilterOptions)
+        std::function<void(uint64_t id)> on_start; // called by a worker before it solves a request; may be empty
+
+        ServiceOptions() : workers(0), max_queue(4096), filter_work_limit(4000000ULL) {}
+    };
+
+    class SolveService {
+    public:
+        typedef std::function<void(const SolveResponse&)> Reply;
+
+        explicit SolveService(const ServiceOptions& options = ServiceOptions());
+        ~SolveService(); // cancels whatever is left and joins the workers
+
+        SolveService(const SolveService&) = delete;
+        SolveService& operator=(const SolveService&) = delete;
+
+        // Queue a SOLVE request; reply is called exactly once, from a worker
+        // (or right here for BUSY). owner scopes request ids, e.g. per connection
+        void submit(const void* owner, SolveRequest request, Reply reply);
+
+        // Cancel owner's request id; false if it already finished (or never existed)
+        bool cancel(const void* owner, uint64_t id);
+
+        // Cancel every queued and running request of owner (its connection closed)
+        void cancel_all(const void* owner);
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+        typedef std::pair<const void*, uint64_t> Key;
+
+        struct Job {
+            Key key;
+            SolveRequest request;
+            Reply reply;
+            Clock::time_point deadline;
+            std::shared_ptr<std::atomic<bool>> stop;
+        };
+
+        ServiceOptions options_;
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<Job> queue_;
+        std::map<Key, std::shared_ptr<std::atomic<bool>>> running_;
+        bool stopping_;
+        std::vector<std::thread> workers_;
+
+        void worker_loop();
+        SolveResponse solve(const Job& job) const;
+        bool cancel_locked(const Key& key, std::vector<Job>& dropped);
+    };
+
+    // Serves frames from in_fd and answers on out_fd until in_fd reaches its end
+    // (stdin mode, or one socket connection). Returns true if SHUTDOWN was received
+    // If the input ends without SHUTDOWN, the stream's queued and running
+    // requests are cancelled before it waits for their replies
+    bool serve_stream(SolveService& service, int in_fd, int out_fd);
+
+    // Listens on a Unix-domain socket, one thread per connection, until a
+    // SHUTDOWN request arrives; the socket file is removed on exit
+    void serve_unix_socket(SolveService& service, const std::string& path);
+
+    // Client side: connects to the service socket; throws std::runtime_error
+    int connect_unix_socket(const std::string& path);
+
+} // namespace threecolor
+
+#endif // SOLVE_SERVICE_HPP
@@ -9,12 +9,13 @@ Custom priority system for 3 color algorithm
   to lowest degree
 - Each bucket has vertices ordered by how many neighbors they have that 
   have been colored
-- Tie breaker is lower vertex ID
+- Tie breaker is lower vertex ID (the TieBreak policy, see policies.hpp)
 */
 #ifndef SORTING_MACHINE_HPP
 #define SORTING_MACHINE_HPP
 
 #include "graph.hpp"
+#include "policies.hpp"
 #include <vector>
 
 namespace threecolor {
@@ -25,9 +26,12 @@ struct Bucket {
     Vertex* head; //doubly-linked list of vertices with this degree
 };
 
-class SortingMachine {
+// Defined in sorting_machine.cpp and instantiated there for
+// LowerIdFirst and HigherIdFirst
+template <class TieBreak>
+class BasicSortingMachine {
 public:
-    SortingMachine();
+    BasicSortingMachine();
 
     // Build buckets from graph degrees; assumes graph.degrees computed
     void initialize(Graph& g);
@@ -55,6 +59,8 @@ private:
 
     int find_bucket_index_for_degree(int degree) const;
 };
+
+using SortingMachine = BasicSortingMachine<LowerIdFirst>;
 } // namespace threecolor
 
 #endif // SORTING_MACHINE_HPP
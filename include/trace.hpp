@@ -0,0 +1,111 @@
+/*
+trace.hpp
+
+Author: Dialo Sall
+
+Step-level trace recording for the 3-color solver
+- Every step of run_greedy() can be written as one fixed-size binary record
+- Records go into a preallocated buffer; full buffers are handed to a
+  background thread that spills them to disk, so the solver never blocks on I/O
+  unless the writer falls a full buffer behind
+- Build with -DTHREECOLOR_TRACE=0 (make TRACE=0) to compile every hook out
+*/
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef THREECOLOR_TRACE
+#define THREECOLOR_TRACE 1
+#endif
+
+namespace threecolor {
+
+    // Where the colored vertex came from
+    enum TraceSource : uint8_t {
+        SOURCE_TRAPPED = 0, // popped from the trapped list
+        SOURCE_MACHINE = 1  // picked by the sorting machine
+    };
+
+    // One solver step, 16 bytes on disk
+    struct TraceRecord {
+        uint32_t step;          // 0-based step index
+        int32_t vertex;         // vertex picked
+        int32_t newly_trapped;  // neighbors that became trapped by this step
+        uint8_t source;         // TraceSource
+        int8_t color;           // color chosen, UNCOLORED if none was available
+        uint8_t contradiction;  // 1 if this step ended the run with a failure
+        uint8_t reserved;
+    };
+    static_assert(sizeof(TraceRecord) == 16, "TraceRecord must stay 16 bytes");
+
+    // File header written once at the start of a trace
+    struct TraceHeader {
+        char magic[4];          // "3CTR"
+        uint32_t version;
+        uint32_t record_size;
+        int32_t num_vertices;
+    };
+    static_assert(sizeof(TraceHeader) == 16, "TraceHeader must stay 16 bytes");
+
+    class TraceRecorder {
+    public:
+        // Opens path for writing; buffer_records is the size of each of the two buffers
+        TraceRecorder(const std::string& path, int num_vertices, size_t buffer_records = 1 << 16);
+        ~TraceRecorder();
+
+        TraceRecorder(const TraceRecorder&) = delete;
+        TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+        // Append one record; only touches the active buffer on the fast path
+        void record(const TraceRecord& r) {
+            if (active_size_ == capacity_) {
+                hand_off_active();
+            }
+            active_[active_size_++] = r;
+            ++total_records_;
+        }
+
+        // Flush everything and stop the writer thread; safe to call twice
+        // Throws std::runtime_error if any record could not be written
+        void close();
+
+        uint64_t total_records() const { return total_records_; }
+
+    private:
+        std::string path_;
+        std::FILE* file_;
+        size_t capacity_;
+
+        std::vector<TraceRecord> buffers_[2];
+        TraceRecord* active_;   // buffer the solver appends to
+        size_t active_size_;
+        int active_index_;
+        uint64_t total_records_;
+
+        // Writer thread state, guarded by mutex_
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        int pending_index_;     // buffer waiting to be written, or -1
+        size_t pending_size_;
+        bool write_failed_;     // a short fwrite in the writer thread
+        bool stopping_;
+        bool closed_;
+        std::thread writer_;
+
+        void hand_off_active();
+        void writer_loop();
+    };
+
+    // Load a whole trace file; throws std::runtime_error on a bad file
+    std::vector<TraceRecord> read_trace(const std::string& path, TraceHeader& header);
+
+} // namespace threecolor
+
+#endif // TRACE_HPP
@@ -0,0 +1,88 @@
+/*
+trapped_queue.hpp
+
+Author: Dialo Sall
+
+Queue of trapped vertices indexed by vertex id
+- prev/next links live in arrays indexed by id, so pushing at either end,
+  popping the front and removing any vertex are all O(1)
+- push_front + pop_front gives the original most-recent-first order,
+  push_back + pop_front gives first-in-first-out
+*/
+#ifndef TRAPPED_QUEUE_HPP
+#define TRAPPED_QUEUE_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace threecolor {
+
+    class TrappedQueue {
+    public:
+        TrappedQueue() : head_(-1), tail_(-1), size_(0) {}
+
+        // Empty the queue and size it for ids 0..n-1
+        void reset(int n) {
+            next_.assign(n, -1);
+            prev_.assign(n, -1);
+            queued_.assign(n, 0);
+            head_ = tail_ = -1;
+            size_ = 0;
+        }
+
+        bool empty() const { return head_ == -1; }
+        int size() const { return size_; }
+        bool contains(int v) const { return queued_[v] != 0; }
+
+        void push_back(int v) {
+            if (queued_[v]) return;
+            queued_[v] = 1;
+            prev_[v] = tail_;
+            next_[v] = -1;
+            if (tail_ != -1) next_[tail_] = v;
+            else head_ = v;
+            tail_ = v;
+            ++size_;
+        }
+
+        void push_front(int v) {
+            if (queued_[v]) return;
+            queued_[v] = 1;
+            prev_[v] = -1;
+            next_[v] = head_;
+            if (head_ != -1) prev_[head_] = v;
+            else tail_ = v;
+            head_ = v;
+            ++size_;
+        }
+
+        // Returns -1 when empty
+        int pop_front() {
+            int v = head_;
+            if (v != -1) remove(v);
+            return v;
+        }
+
+        void remove(int v) {
+            if (!queued_[v]) return;
+            if (prev_[v] != -1) next_[prev_[v]] = next_[v];
+            else head_ = next_[v];
+            if (next_[v] != -1) prev_[next_[v]] = prev_[v];
+            else tail_ = prev_[v];
+            prev_[v] = next_[v] = -1;
+            queued_[v] = 0;
+            --size_;
+        }
+
+    private:
+        std::vector<int> next_;
+        std::vector<int> prev_;
+        std::vector<uint8_t> queued_;
+        int head_;
+        int tail_;
+        int size_;
+    };
+
+} // namespace threecolor
+
+#endif // TRAPPED_QUEUE_HPP
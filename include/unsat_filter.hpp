@@ -0,0 +1,65 @@
+/*
+unsat_filter.hpp
+
+Author: Dialo Sall
+
+Pre-solve filter that proves a graph is NOT 3-colorable
+- K4: four mutually adjacent vertices need four colors
+- Odd wheel: a hub joined to every vertex of an odd cycle; the cycle needs
+  three colors on its own, leaving none for the hub (K4 is the 3-spoke wheel)
+- When a witness is found the solvers never have to run, and the failure
+  is certain instead of "the greedy got stuck"
+- Both searches stop after a bounded amount of work, so the filter costs at
+  most a CSR copy plus the two work limits
+
+Finding nothing does not mean the graph is 3-colorable.
+*/
+#ifndef UNSAT_FILTER_HPP
+#define UNSAT_FILTER_HPP
+
+#include "graph.hpp"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace threecolor {
+
+    enum class WitnessKind {
+        NONE,       // nothing found
+        K4,         // vertices = the four clique vertices
+        ODD_WHEEL   // vertices = hub, then the rim cycle in order
+    };
+
+    struct UnsatWitness {
+        WitnessKind kind;
+        std::vector<int> vertices;
+        std::vector<std::pair<int, int>> edges; // every edge of the witness subgraph
+
+        bool found() const { return kind != WitnessKind::NONE; }
+    };
+
+    struct UnsatFilterOptions {
+        bool find_k4;
+        bool find_odd_wheels;
+        uint64_t k4_work_limit;        // forward adjacency entries scanned by the K4 search; 0 = no limit
+        uint64_t odd_wheel_work_limit; // adjacency entries scanned by the wheel search; 0 = no limit
+
+        UnsatFilterOptions()
+            : find_k4(true), find_odd_wheels(true), k4_work_limit(200000000ULL),
+              odd_wheel_work_limit(200000000ULL) {}
+    };
+
+    // Search g for a K4 or an odd wheel
+    UnsatWitness find_unsat_witness(const Graph& g, const UnsatFilterOptions& options = UnsatFilterOptions());
+
+    // Check the witness against g: a K4 is 4 distinct, pairwise adjacent vertices;
+    // an odd wheel is a hub adjacent to every vertex of an odd rim cycle (length >= 3),
+    // listed as hub then rim in cycle order. Every listed edge must exist in g too
+    bool witness_is_valid(const Graph& g, const UnsatWitness& witness);
+
+    // "K4" / "odd wheel" / "none"
+    const char* witness_kind_name(WitnessKind kind);
+
+} // namespace threecolor
+
+#endif // UNSAT_FILTER_HPP
@@ -9,17 +9,56 @@ Main use is to generate graphs for quick testing of algorithm
 #define UTILITIES_HPP
 
 #include "graph.hpp"
+#include <cstdint>
 #include <string>
 #include <random>
+#include <vector>
 
 namespace threecolor {
 
     //random graph generator
     Graph generate_random_graph(int n, double p, std::mt19937& rng);
 
+    // Output formats understood by export_graph
+    enum class ExportFormat {
+        NONE,           // skip exporting entirely
+        DOT,            // full graph with colors, for Graphviz
+        COLORS_TEXT,    // one color per line: 0/1/2, or -1 if uncolored
+        COLORS_BINARY,  // one byte per vertex: 0/1/2, or 255 if uncolored
+        DIMACS,         // 3-coloring as CNF for an external SAT solver; var 3v+c+1 = "v has color c"
+        EDGE_LIST       // "n m" then "u v" per edge, the input format of Graph::from_edge_list_file
+    };
+
+    // Parses "none", "dot", "text", "binary", "dimacs" or "edges"; throws std::invalid_argument otherwise
+    ExportFormat parse_export_format(const std::string& name);
+
+    // File extension matching a format, e.g. ".dot"
+    const char* export_extension(ExportFormat format);
+
+    // Write g in the given format; chunk_size is the writer buffer size in bytes
+    // Returns the number of bytes written
+    uint64_t export_graph(const Graph& g, const std::string& path, ExportFormat format,
+                          size_t chunk_size = 1 << 20);
+
+    // Random graph that is 3-colorable by construction: every vertex gets a hidden
+    // color and edges (probability p) only join vertices with different hidden colors
+    // If planted is given it receives the hidden coloring
+    Graph generate_planted_graph(int n, double p, std::mt19937& rng, std::vector<Color>* planted = nullptr);
+
+    // Same edge distributions as the two generators above, but each edge is
+    // found with a geometric skip, so a graph costs O(n + m) instead of O(n^2)
+    // Needed for the million-vertex benchmarks; they draw from rng differently,
+    // so a seed gives another graph than generate_random_graph / generate_planted_graph
+    Graph generate_sparse_random_graph(int n, double p, std::mt19937& rng);
+    Graph generate_sparse_planted_graph(int n, double p, std::mt19937& rng, std::vector<Color>* planted = nullptr);
+
     //Export graph and coloring to DOT file for visualization
     void export_to_dot(const Graph& g, const std::string& path);
 
+    // Compact coloring-only exports (no edges)
+    void export_coloring_text(const Graph& g, const std::string& path);
+    void export_coloring_binary(const Graph& g, const std::string& path);
+
     //Helper to get random seed
     std::mt19937 make_rng();
     
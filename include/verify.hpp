@@ -0,0 +1,35 @@
+/*
+verify.hpp
+
+Author: Dialo Sall
+
+Coloring verification shared by every solver
+- Vertices are split across threads; each edge is checked once (u < v)
+- The first violation sets a shared flag so every thread stops early
+- Returns a report describing what went wrong instead of a bare bool
+*/
+#ifndef VERIFY_HPP
+#define VERIFY_HPP
+
+#include "graph.hpp"
+#include <cstdint>
+
+namespace threecolor {
+
+    struct VerifyReport {
+        bool valid;                 // true if every vertex is colored and no edge is monochromatic
+        int bad_vertex;             // an uncolored vertex, or -1
+        int bad_u, bad_v;           // a monochromatic edge, or -1 -1
+        int uncolored_vertices;     // uncolored vertices seen
+        uint64_t conflicting_edges; // monochromatic edges seen
+        int vertices_checked;       // smaller than n when the scan stopped early
+        uint64_t edges_checked;
+    };
+
+    // num_threads <= 0 uses every hardware thread; 1 runs on the calling thread only
+    // With stop_at_first = false the whole graph is scanned and the counts are totals
+    VerifyReport verify_coloring_parallel(const Graph& g, int num_threads = 0, bool stop_at_first = true);
+
+} // namespace threecolor
+
+#endif // VERIFY_HPP
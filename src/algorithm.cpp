@@ -25,17 +25,32 @@ Algorithm steps:
     4. Return success if all vertices are colored
 */
 #include "algorithm.hpp"
+#include "dense_solver.hpp"
+#include "verify.hpp"
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
 
 namespace threecolor {
 
-ThreeColorSolver::ThreeColorSolver(Graph& g)
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::BasicThreeColorSolver(Graph& g)
     : graph_(g),
       machine_(),
-      trapped_head_(nullptr) {}
+      trapped_(),
+      stats_{0, 0, 0, 0},
+      tracer_(nullptr),
+      newly_trapped_(0),
+      color_counts_{0, 0, 0} {}
 
-bool ThreeColorSolver::run_greedy() {
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+bool BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::run_greedy() {
     initialize_state();
 
+#if THREECOLOR_TRACE
+    uint32_t step = 0;
+#endif
+
     while (true) {
         if (machine_.empty()) {
             // All uncolored vertices removed → success
@@ -43,10 +58,14 @@ bool ThreeColorSolver::run_greedy() {
         }
 
         // 1. Trapped vertex first
-        Vertex* v = pop_trapped();
+        Vertex* v = TrappedPolicy::propagate ? pop_trapped() : nullptr;
+#if THREECOLOR_TRACE
+        uint8_t source = v ? SOURCE_TRAPPED : SOURCE_MACHINE;
+#endif
         if (v) {
             // ensure it's also removed from sorting machine
             machine_.remove(v);
+            ++stats_.propagated;
         } else {
             // 2. Else pick from sorting machine
             v = machine_.pick_next_vertex();
@@ -55,7 +74,9 @@ bool ThreeColorSolver::run_greedy() {
                 return true;
             }
             machine_.remove(v);
+            ++stats_.machine_picks;
         }
+        ++stats_.steps;
 
         // Determine color
         Color c = trapped_color(v);
@@ -65,73 +86,107 @@ bool ThreeColorSolver::run_greedy() {
 
         if (c == UNCOLORED) {
             // No available color
+#if THREECOLOR_TRACE
+            if (tracer_) {
+                tracer_->record(TraceRecord{step, v->id, 0, source, static_cast<int8_t>(UNCOLORED), 1, 0});
+            }
+#endif
             return false; // Greedy failure; with backtracking you'd branch here
         }
 
         v->color = c;
+        ++color_counts_[c];
 
         // Update neighbors; if we hit contradiction, fail
-        if (!update_neighbors(v, c)) {
+#if THREECOLOR_TRACE
+        newly_trapped_ = 0;
+#endif
+        bool ok = update_neighbors(v, c);
+#if THREECOLOR_TRACE
+        if (tracer_) {
+            tracer_->record(TraceRecord{step++, v->id, newly_trapped_, source,
+                                        static_cast<int8_t>(c), static_cast<uint8_t>(!ok), 0});
+        }
+#endif
+        if (!ok) {
             return false;
         }
     }
 }
 
+Engine parse_engine(const std::string& name) {
+    if (name == "auto")   return Engine::AUTO;
+    if (name == "sparse") return Engine::SPARSE;
+    if (name == "dense")  return Engine::DENSE;
+    throw std::invalid_argument("Unknown engine: " + name);
+}
+
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+bool BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::solve(Engine engine) {
+    // the bitset engine hardcodes the default policies
+    constexpr bool default_policies = std::is_same<BasicThreeColorSolver, ThreeColorSolver>::value;
+    if (engine == Engine::AUTO) {
+        // a tracer asks for step records, which only the sparse loop emits
+        bool dense = default_policies && tracer_ == nullptr && DenseSolver::prefers_dense(graph_);
+        engine = dense ? Engine::DENSE : Engine::SPARSE;
+    }
+
+    if (engine == Engine::DENSE) {
+        if (!default_policies) {
+            throw std::invalid_argument("Dense engine only supports the default policies");
+        }
+        DenseSolver dense(graph_);
+        return dense.run_greedy();
+    }
+    return run_greedy();
+}
+
 // Initializes graph state as fully uncolored, no trapped vertices, and a new sorting machine
-void ThreeColorSolver::initialize_state() {
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+void BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::initialize_state() {
     graph_.reset_coloring_state();
-    trapped_head_ = nullptr;
+    trapped_.reset(graph_.num_vertices());
+    stats_ = GreedyStats{0, 0, 0, 0};
+    color_counts_[RED] = color_counts_[BLUE] = color_counts_[YELLOW] = 0;
     machine_.initialize(graph_);
 }
 
 // Flags vertex as trapped so that it is immediately colored
-void ThreeColorSolver::add_trapped(Vertex* v) {
-    // Simple push-front onto singly linked list using next_in_bucket as next ptr
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+void BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::add_trapped(Vertex* v) {
     if (v->is_trapped) return;
     v->is_trapped = true;
-    v->next_trapped = trapped_head_;
-    trapped_head_ = v;
+    // newest first by default, oldest first for FIFO policies
+    if (TrappedPolicy::fifo) trapped_.push_back(v->id);
+    else trapped_.push_front(v->id);
+#if THREECOLOR_TRACE
+    ++newly_trapped_;
+#endif
 }
 
-// Removes vertex from trapped list
-void ThreeColorSolver::remove_trapped(Vertex* v) {
+// Removes vertex from trapped list in O(1)
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+void BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::remove_trapped(Vertex* v) {
     if (!v->is_trapped) return;
-    // linear removal from trapped list; OK because trapped list should be small
-    Vertex* prev = nullptr;
-    Vertex* cur = trapped_head_;
-    while (cur) {
-        if (cur == v) {
-            if (prev) prev->next_trapped = cur->next_trapped;
-            else trapped_head_ = cur->next_trapped;
-            break;
-        }
-        prev = cur;
-        cur = cur->next_trapped;
-    }
+    trapped_.remove(v->id);
     v->is_trapped = false;
-    v->next_trapped = nullptr;
 }
 
 // Removes the first vertex in the trapped list
-Vertex* ThreeColorSolver::pop_trapped() {
-    Vertex* v = trapped_head_;
-    while (v && v->color != UNCOLORED) {
-        // skip any that might have been colored later
-        trapped_head_ = v->next_trapped;
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+Vertex* BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::pop_trapped() {
+    while (!trapped_.empty()) {
+        Vertex* v = &graph_.vertex(trapped_.pop_front());
         v->is_trapped = false;
-        v->next_trapped = nullptr;
-        v = trapped_head_;
+        // skip any that might have been colored later
+        if (v->color == UNCOLORED) return v;
     }
-    if (!v) return nullptr;
-
-    trapped_head_ = v->next_trapped;
-    v->is_trapped = false;
-    v->next_trapped = nullptr;
-    return v;
+    return nullptr;
 }
 
 // Counts the available colors for vertex v
-int ThreeColorSolver::available_color_count(const Vertex* v) const {
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+int BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::available_color_count(const Vertex* v) const {
     uint8_t avail = static_cast<uint8_t>(~v->forbidden_mask) & 0b111;
     int count = 0;
     while (avail) {
@@ -142,7 +197,8 @@ int ThreeColorSolver::available_color_count(const Vertex* v) const {
 }
 
 // Gets the only possible color for vertex v
-Color ThreeColorSolver::trapped_color(const Vertex* v) const {
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+Color BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::trapped_color(const Vertex* v) const {
     uint8_t avail = static_cast<uint8_t>(~v->forbidden_mask) & 0b111;
     int count = 0;
     int last_color = -1;
@@ -159,20 +215,18 @@ Color ThreeColorSolver::trapped_color(const Vertex* v) const {
 }
 
 // Chooses the highest priority color available for vertex v
-Color ThreeColorSolver::choose_color_with_priority(const Vertex* v) const {
-    // Color priority: RED, then BLUE, then YELLOW
-    uint8_t forb = v->forbidden_mask;
-    if ((forb & (1 << RED)) == 0)    return RED;
-    if ((forb & (1 << BLUE)) == 0)   return BLUE;
-    if ((forb & (1 << YELLOW)) == 0) return YELLOW;
-    return UNCOLORED;
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+Color BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::choose_color_with_priority(const Vertex* v) const {
+    // Color priority comes from the policy: RED, then BLUE, then YELLOW by default
+    return ColorPolicy::choose(v->forbidden_mask, color_counts_);
 }
 
 // Updates neighbors of vertex v of it's newly defined color
-bool ThreeColorSolver::update_neighbors(Vertex* v, Color c) {
-    for (Neighbor* p = v->neighbors_head; p != nullptr; p = p->next) {
-        Vertex* u = p->v;
-        if (u->color != UNCOLORED) continue;
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+bool BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::update_neighbors(Vertex* v, Color c) {
+    return graph_.for_each_neighbor(v->id, [&](int id) {
+        Vertex* u = &graph_.vertex(id);
+        if (u->color != UNCOLORED) return true;
 
         // Update forbidden mask
         uint8_t old_mask = u->forbidden_mask;
@@ -185,7 +239,13 @@ bool ThreeColorSolver::update_neighbors(Vertex* v, Color c) {
                 // No color available: contradiction
                 return false;
             } else if (avail_count == 1) {
-                add_trapped(u);
+                if (TrappedPolicy::propagate) {
+                    add_trapped(u);
+                    if (TrappedPolicy::forced_conflicts && has_forced_conflict(u)) {
+                        ++stats_.forced_conflicts;
+                        return false;
+                    }
+                }
             } else {
                 // Not trapped anymore if previously trapped
                 if (u->is_trapped) {
@@ -196,20 +256,103 @@ bool ThreeColorSolver::update_neighbors(Vertex* v, Color c) {
 
         // Bump colored_neighbors and reposition in sorting machine
         machine_.bump_colored_neighbors(u);
-    }
-    return true;
+        return true;
+    });
+}
+
+// Two adjacent vertices that can each only take the same color can never both be colored
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+bool BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::has_forced_conflict(const Vertex* u) const {
+    Color forced = trapped_color(u);
+    // the walk stops (returns false) at the first conflicting neighbor
+    return !graph_.for_each_neighbor(u->id, [&](int id) {
+        const Vertex* w = &graph_.vertex(id);
+        return !(w->is_trapped && w->color == UNCOLORED && trapped_color(w) == forced);
+    });
 }
 
 // Verifies that 3 color graph is a valid solution
-bool ThreeColorSolver::verify_coloring() const {
-    for (int i = 0; i < graph_.num_vertices(); ++i) {
-        const Vertex& v = graph_.vertex(i);
-        if (v.color == UNCOLORED) return false;
-        for (Neighbor* p = v.neighbors_head; p != nullptr; p = p->next) {
-            if (p->v->color == v.color) return false;
-        }
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+bool BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy>::verify_coloring() const {
+    // serial run of the shared verifier: each edge checked once, stop at first violation
+    return verify_coloring_parallel(graph_, 1).valid;
+}
+
+PolicyConfig parse_policy(const std::string& spec) {
+    PolicyConfig config;
+    std::stringstream in(spec);
+    std::string word;
+    while (std::getline(in, word, ',')) {
+        if (word == "rby")             config.color = ColorRule::RED_BLUE_YELLOW;
+        else if (word == "least-used") config.color = ColorRule::LEAST_USED;
+        else if (word == "most-used")  config.color = ColorRule::MOST_USED;
+        else if (word == "lower-id")   config.higher_id_first = false;
+        else if (word == "higher-id")  config.higher_id_first = true;
+        else if (word == "trapped")    config.trapped = TrappedRule::PROPAGATE;
+        else if (word == "no-trapped") config.trapped = TrappedRule::IGNORE;
+        else if (word == "forced")     config.trapped = TrappedRule::FORCED;
+        else throw std::invalid_argument("Unknown policy: " + word);
     }
-    return true;
+    return config;
 }
 
+namespace {
+
+template <class ColorPolicy, class TieBreak, class TrappedPolicy>
+bool run_specialization(Graph& g, Engine engine, TraceRecorder* tracer, GreedyStats* stats) {
+    BasicThreeColorSolver<ColorPolicy, TieBreak, TrappedPolicy> solver(g);
+    solver.set_tracer(tracer);
+    bool ok = solver.solve(engine);
+    if (stats) *stats = solver.stats();
+    return ok;
+}
+
+template <class ColorPolicy, class TieBreak>
+bool dispatch_trapped(Graph& g, const PolicyConfig& config, Engine engine, TraceRecorder* tracer, GreedyStats* stats) {
+    switch (config.trapped) {
+        case TrappedRule::IGNORE: return run_specialization<ColorPolicy, TieBreak, IgnoreTrapped>(g, engine, tracer, stats);
+        case TrappedRule::FORCED: return run_specialization<ColorPolicy, TieBreak, ForcedPropagation>(g, engine, tracer, stats);
+        case TrappedRule::PROPAGATE: break;
+    }
+    return run_specialization<ColorPolicy, TieBreak, PropagateTrapped>(g, engine, tracer, stats);
+}
+
+template <class ColorPolicy>
+bool dispatch_tie_break(Graph& g, const PolicyConfig& config, Engine engine, TraceRecorder* tracer, GreedyStats* stats) {
+    if (config.higher_id_first) return dispatch_trapped<ColorPolicy, HigherIdFirst>(g, config, engine, tracer, stats);
+    return dispatch_trapped<ColorPolicy, LowerIdFirst>(g, config, engine, tracer, stats);
+}
+
+} // namespace
+
+bool run_greedy_with_policy(Graph& g, const PolicyConfig& config, Engine engine, TraceRecorder* tracer,
+                            GreedyStats* stats) {
+    switch (config.color) {
+        case ColorRule::LEAST_USED: return dispatch_tie_break<LeastUsedColor>(g, config, engine, tracer, stats);
+        case ColorRule::MOST_USED:  return dispatch_tie_break<MostUsedColor>(g, config, engine, tracer, stats);
+        case ColorRule::RED_BLUE_YELLOW: break;
+    }
+    return dispatch_tie_break<RedBlueYellow>(g, config, engine, tracer, stats);
+}
+
+// Every policy combination, so other files can use any of them
+template class BasicThreeColorSolver<RedBlueYellow, LowerIdFirst, PropagateTrapped>;
+template class BasicThreeColorSolver<RedBlueYellow, LowerIdFirst, IgnoreTrapped>;
+template class BasicThreeColorSolver<RedBlueYellow, LowerIdFirst, ForcedPropagation>;
+template class BasicThreeColorSolver<RedBlueYellow, HigherIdFirst, PropagateTrapped>;
+template class BasicThreeColorSolver<RedBlueYellow, HigherIdFirst, IgnoreTrapped>;
+template class BasicThreeColorSolver<RedBlueYellow, HigherIdFirst, ForcedPropagation>;
+template class BasicThreeColorSolver<LeastUsedColor, LowerIdFirst, PropagateTrapped>;
+template class BasicThreeColorSolver<LeastUsedColor, LowerIdFirst, IgnoreTrapped>;
+template class BasicThreeColorSolver<LeastUsedColor, LowerIdFirst, ForcedPropagation>;
+template class BasicThreeColorSolver<LeastUsedColor, HigherIdFirst, PropagateTrapped>;
+template class BasicThreeColorSolver<LeastUsedColor, HigherIdFirst, IgnoreTrapped>;
+template class BasicThreeColorSolver<LeastUsedColor, HigherIdFirst, ForcedPropagation>;
+template class BasicThreeColorSolver<MostUsedColor, LowerIdFirst, PropagateTrapped>;
+template class BasicThreeColorSolver<MostUsedColor, LowerIdFirst, IgnoreTrapped>;
+template class BasicThreeColorSolver<MostUsedColor, LowerIdFirst, ForcedPropagation>;
+template class BasicThreeColorSolver<MostUsedColor, HigherIdFirst, PropagateTrapped>;
+template class BasicThreeColorSolver<MostUsedColor, HigherIdFirst, IgnoreTrapped>;
+template class BasicThreeColorSolver<MostUsedColor, HigherIdFirst, ForcedPropagation>;
+
 } // namespace threecolor
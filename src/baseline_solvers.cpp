@@ -0,0 +1,220 @@
+/*
+baseline_solvers.cpp
+
+Author: Dialo Sall
+
+Implementation of baseline_solvers.hpp
+*/
+#include "baseline_solvers.hpp"
+#include <algorithm>
+
+namespace threecolor {
+
+namespace {
+
+    // Distinct neighbor colors for each forbidden_mask
+    constexpr int kSaturation[8] = {0, 1, 1, 2, 1, 2, 2, 3};
+
+    // RED, then BLUE, then YELLOW
+    inline Color first_free_color(uint8_t mask) {
+        if ((mask & 1) == 0) return RED;
+        if ((mask & 2) == 0) return BLUE;
+        if ((mask & 4) == 0) return YELLOW;
+        return UNCOLORED;
+    }
+
+    enum : uint8_t { ALLOWED = 0, EXCLUDED = 1, COLORED = 2 };
+
+} // namespace
+
+// ---------------- DSATUR ----------------
+
+DsaturSolver::DsaturSolver(Graph& g)
+    : graph_(g), stats_{0, 0, -1}, max_degree_(0), top_{-1, -1, -1} {}
+
+int DsaturSolver::bucket_of(const Vertex* v) const {
+    int degree = std::max(0, std::min(max_degree_, v->degree - v->colored_neighbors));
+    return kSaturation[v->forbidden_mask & 0b111] * (max_degree_ + 1) + degree;
+}
+
+// Newest first within a bucket, like the trapped queue
+void DsaturSolver::insert(Vertex* v) {
+    int bucket = bucket_of(v);
+    v->prev_in_bucket = nullptr;
+    v->next_in_bucket = heads_[bucket];
+    if (heads_[bucket]) heads_[bucket]->prev_in_bucket = v;
+    heads_[bucket] = v;
+
+    int saturation = bucket / (max_degree_ + 1);
+    top_[saturation] = std::max(top_[saturation], bucket % (max_degree_ + 1));
+}
+
+// Must run before v's mask or colored_neighbors change
+void DsaturSolver::remove(Vertex* v) {
+    if (v->prev_in_bucket) v->prev_in_bucket->next_in_bucket = v->next_in_bucket;
+    else heads_[bucket_of(v)] = v->next_in_bucket;
+    if (v->next_in_bucket) v->next_in_bucket->prev_in_bucket = v->prev_in_bucket;
+    v->next_in_bucket = nullptr;
+    v->prev_in_bucket = nullptr;
+}
+
+Vertex* DsaturSolver::pick_next_vertex() {
+    for (int saturation = 2; saturation >= 0; --saturation) {
+        int& top = top_[saturation];
+        const int base = saturation * (max_degree_ + 1);
+        while (top >= 0 && heads_[base + top] == nullptr) --top;
+        if (top >= 0) return heads_[base + top];
+    }
+    return nullptr;
+}
+
+bool DsaturSolver::run_greedy() {
+    graph_.reset_coloring_state();
+    const int n = graph_.num_vertices();
+    stats_ = BaselineStats{0, static_cast<uint64_t>(n), -1};
+
+    max_degree_ = 0;
+    for (int v = 0; v < n; ++v) max_degree_ = std::max(max_degree_, graph_.vertex(v).degree);
+    heads_.assign(3 * static_cast<size_t>(max_degree_ + 1), nullptr);
+    top_[0] = top_[1] = top_[2] = -1;
+    // highest id first, so lower ids end up at the front of each bucket
+    for (int v = n - 1; v >= 0; --v) insert(&graph_.vertex(v));
+
+    while (Vertex* v = pick_next_vertex()) {
+        remove(v);
+        Color c = first_free_color(v->forbidden_mask);
+        v->color = c;
+        ++stats_.steps;
+        --stats_.uncolored;
+
+        const uint8_t bit = static_cast<uint8_t>(1u << c);
+        bool ok = graph_.for_each_neighbor(v->id, [&](int id) {
+            Vertex& u = graph_.vertex(id);
+            if (u.color != UNCOLORED) return true;
+            remove(&u);
+            ++u.colored_neighbors;
+            u.forbidden_mask |= bit;
+            if (u.forbidden_mask == 0b111) {
+                stats_.contradiction = id;
+                return false;
+            }
+            insert(&u);
+            return true;
+        });
+        if (!ok) return false;
+    }
+    return true;
+}
+
+// ---------------- RLF ----------------
+
+RlfSolver::RlfSolver(Graph& g)
+    : graph_(g), stats_{0, 0, -1} {}
+
+// Max-heap order: most excluded neighbors, then fewest allowed, then lower id
+bool RlfSolver::Candidate::operator<(const Candidate& other) const {
+    if (excluded != other.excluded) return excluded < other.excluded;
+    if (allowed != other.allowed) return allowed > other.allowed;
+    return id > other.id;
+}
+
+void RlfSolver::push_candidate(int v) {
+    heap_.push_back(Candidate{excluded_[v], allowed_[v], v});
+    std::push_heap(heap_.begin(), heap_.end());
+}
+
+// Next vertex for the current color, or -1 once nothing can take it
+int RlfSolver::pop_candidate() {
+    while (!heap_.empty()) {
+        std::pop_heap(heap_.begin(), heap_.end());
+        Candidate top = heap_.back();
+        heap_.pop_back();
+        if (state_[top.id] == ALLOWED && top.excluded == excluded_[top.id] && top.allowed == allowed_[top.id]) {
+            return top.id;
+        }
+    }
+    return -1;
+}
+
+void RlfSolver::take_color(int v, Color c) {
+    graph_.vertex(v).color = c;
+    state_[v] = COLORED;
+    ++stats_.steps;
+    --stats_.uncolored;
+
+    const uint8_t bit = static_cast<uint8_t>(1u << c);
+    graph_.for_each_neighbor(v, [&](int u) {
+        Vertex& w = graph_.vertex(u);
+        if (w.color == UNCOLORED) {
+            ++w.colored_neighbors;
+            w.forbidden_mask |= bit;
+        }
+        if (state_[u] != ALLOWED) return true;
+
+        // u can no longer take c; its allowed neighbors now have one more excluded neighbor
+        state_[u] = EXCLUDED;
+        graph_.for_each_neighbor(u, [&](int x) {
+            if (state_[x] == ALLOWED) {
+                ++excluded_[x];
+                --allowed_[x];
+                push_candidate(x);
+            }
+            return true;
+        });
+        return true;
+    });
+}
+
+void RlfSolver::fill_color(Color c) {
+    const int n = graph_.num_vertices();
+    for (int v = 0; v < n; ++v) {
+        if (state_[v] == COLORED) continue;
+        state_[v] = ALLOWED;
+        excluded_[v] = 0;
+        allowed_[v] = 0;
+    }
+
+    int first = -1;
+    heap_.clear();
+    for (int v = 0; v < n; ++v) {
+        if (state_[v] != ALLOWED) continue;
+        int allowed = 0;
+        graph_.for_each_neighbor(v, [&](int u) {
+            allowed += state_[u] == ALLOWED;
+            return true;
+        });
+        allowed_[v] = allowed;
+        if (first < 0 || allowed > allowed_[first]) first = v;
+        heap_.push_back(Candidate{0, allowed, v});
+    }
+    if (first < 0) return;
+    std::make_heap(heap_.begin(), heap_.end());
+
+    take_color(first, c);
+    for (int v = pop_candidate(); v >= 0; v = pop_candidate()) take_color(v, c);
+}
+
+bool RlfSolver::run_greedy() {
+    graph_.reset_coloring_state();
+    const int n = graph_.num_vertices();
+    stats_ = BaselineStats{0, static_cast<uint64_t>(n), -1};
+    state_.assign(n, ALLOWED);
+    excluded_.assign(n, 0);
+    allowed_.assign(n, 0);
+
+    for (Color c : {RED, BLUE, YELLOW}) {
+        if (stats_.uncolored == 0) break;
+        fill_color(c);
+    }
+    if (stats_.uncolored == 0) return true;
+
+    for (int v = 0; v < n; ++v) {
+        if (state_[v] != COLORED) {
+            stats_.contradiction = v;
+            break;
+        }
+    }
+    return false;
+}
+
+} // namespace threecolor
@@ -0,0 +1,63 @@
+/*
+buffered_writer.cpp
+
+Author: Dialo Sall
+
+Implementation of buffered_writer.hpp
+
+*/
+#include "buffered_writer.hpp"
+#include <stdexcept>
+
+namespace threecolor {
+
+    BufferedWriter::BufferedWriter(const std::string& path, size_t chunk_size)
+        : file_(nullptr), buffer_(chunk_size > 64 ? chunk_size : 64), size_(0), bytes_written_(0)
+    {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) {
+            throw std::runtime_error("Could not open output file: " + path);
+        }
+        // stdio buffering would only copy our chunks a second time
+        std::setvbuf(file_, nullptr, _IONBF, 0);
+    }
+
+    BufferedWriter::~BufferedWriter() {
+        // destructors must not throw; call close() directly to see write errors
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    void BufferedWriter::flush_chunk() {
+        if (size_ == 0) return;
+        write_raw(buffer_.data(), size_);
+        size_ = 0;
+    }
+
+    void BufferedWriter::write_raw(const char* data, size_t len) {
+        if (std::fwrite(data, 1, len, file_) != len) {
+            throw std::runtime_error("Write to output file failed");
+        }
+        bytes_written_ += len;
+    }
+
+    void BufferedWriter::close() {
+        if (!file_) return;
+        try {
+            flush_chunk();
+        } catch (...) {
+            std::fclose(file_);
+            file_ = nullptr;
+            throw;
+        }
+        // fclose can still fail where the data only reaches the disk on close (e.g. NFS)
+        int result = std::fclose(file_);
+        file_ = nullptr;
+        if (result != 0) {
+            throw std::runtime_error("Closing output file failed");
+        }
+    }
+
+} // namespace threecolor
@@ -0,0 +1,600 @@
+/*
+cdcl_solver.cpp
+
+Author: Dialo Sall
+
+Implementation of cdcl_solver.hpp
+
+Main loop of solve():
+    1. Propagate everything implied by the current assignment
+        - a color on v removes it from v's other colors and from every neighbor
+        - a vertex with two colors ruled out takes the third
+        - learned clauses with one non-false literal left force it
+    2. On a conflict: learn a first-UIP clause, jump back to the level where
+       it becomes unit, and assert it (a conflict at level 0 means UNSAT)
+    3. Otherwise restart if the Luby schedule says so (and snapshot the
+       search if a checkpoint is due), trim the learned
+       clauses if there are too many, and decide: the most active uncolored
+       vertex takes its saved color (or the first color still allowed)
+    4. No uncolored vertex left means every constraint holds: SAT
+*/
+#include "cdcl_solver.hpp"
+#include "checkpoint.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace threecolor {
+
+namespace {
+
+    // Luby sequence 1 1 2 1 1 2 4 1 1 2 ... (0-based index)
+    uint64_t luby(uint64_t index) {
+        uint64_t size = 1, seq = 0;
+        while (size < index + 1) {
+            ++seq;
+            size = 2 * size + 1;
+        }
+        while (size - 1 != index) {
+            size = (size - 1) >> 1;
+            --seq;
+            index = index % size;
+        }
+        return 1ULL << seq;
+    }
+
+} // namespace
+
+const char* solve_status_name(SolveStatus status) {
+    switch (status) {
+        case SolveStatus::SATISFIABLE:   return "SATISFIABLE";
+        case SolveStatus::UNSATISFIABLE: return "UNSATISFIABLE";
+        case SolveStatus::UNKNOWN:       break;
+    }
+    return "UNKNOWN";
+}
+
+CdclSolver::CdclSolver(Graph& g, const CdclOptions& options)
+    : graph_(g),
+      options_(options),
+      stats_{0, 0, 0, 0, 0, 0},
+      n_(g.num_vertices()),
+      adj_(CsrGraph::from_graph(g, 1)),
+      qhead_(0),
+      activity_inc_(1.0),
+      clause_inc_(1.0),
+      learned_limit_(options.learned_limit),
+      lbd_counter_(0),
+      restart_index_(0),
+      conflicts_until_restart_(luby(0) * options.restart_base),
+      graph_hash_(0)
+{
+    int vars = 3 * n_;
+    value_.assign(vars, -1);
+    level_.assign(vars, 0);
+    reason_.assign(vars, Reason{REASON_NONE, 0});
+    seen_.assign(vars, 0);
+    watches_.resize(2 * vars);
+    trail_.reserve(vars);
+
+    forbidden_mask_.assign(n_, 0);
+    color_.assign(n_, -1);
+    phase_.assign(n_, -1);
+    lbd_stamp_.assign(n_ + 1, 0);
+
+    // Seed activity by degree so early decisions follow the sorting machine's
+    // priority; seeds stay below one bump so learned activity takes over quickly
+    int max_degree = 1;
+    for (int v = 0; v < n_; ++v) max_degree = std::max(max_degree, adj_.degree(v));
+    activity_.resize(n_);
+    heap_index_.assign(n_, -1);
+    for (int v = 0; v < n_; ++v) {
+        activity_[v] = static_cast<double>(adj_.degree(v)) / (max_degree + 1);
+        heap_insert(v);
+    }
+}
+
+SolveStatus CdclSolver::solve() {
+    while (true) {
+        if (!propagate()) {
+            ++stats_.conflicts;
+            if (decision_level() == 0) {
+                graph_.reset_coloring_state();
+                return SolveStatus::UNSATISFIABLE;
+            }
+
+            int backtrack_level = 0;
+            analyze(backtrack_level);
+            backtrack(backtrack_level);
+
+            if (learnt_.size() == 1) {
+                enqueue(learnt_[0], Reason{REASON_NONE, 0});
+            } else {
+                add_learned(learnt_);
+                enqueue(learnt_[0], Reason{REASON_CLAUSE, static_cast<int>(clauses_.size()) - 1});
+            }
+
+            activity_inc_ /= 0.95;
+            clause_inc_ /= 0.999;
+            if (conflicts_until_restart_ > 0) --conflicts_until_restart_;
+
+            if (out_of_budget()) {
+                backtrack(0);
+                if (options_.checkpoint) save_checkpoint();
+                graph_.reset_coloring_state();
+                return SolveStatus::UNKNOWN;
+            }
+            continue;
+        }
+
+        if (conflicts_until_restart_ == 0) {
+            backtrack(0);
+            ++stats_.restarts;
+            conflicts_until_restart_ = luby(++restart_index_) * options_.restart_base;
+            if (options_.checkpoint && options_.checkpoint->due()) save_checkpoint();
+        }
+
+        if (static_cast<int>(learned_.size()) >= learned_limit_) {
+            reduce_learned();
+            learned_limit_ += learned_limit_ / 10;
+        }
+
+        if ((stats_.decisions & 1023) == 0 && out_of_budget()) {
+            backtrack(0);
+            if (options_.checkpoint) save_checkpoint();
+            graph_.reset_coloring_state();
+            return SolveStatus::UNKNOWN;
+        }
+
+        int lit = pick_decision();
+        if (lit < 0) {
+            write_back();
+            return SolveStatus::SATISFIABLE;
+        }
+        ++stats_.decisions;
+        trail_lim_.push_back(static_cast<int>(trail_.size()));
+        enqueue(lit, Reason{REASON_NONE, 0});
+    }
+}
+
+bool CdclSolver::out_of_budget() const {
+    if (options_.stop && options_.stop->load(std::memory_order_relaxed)) return true;
+    if (options_.max_conflicts > 0 && stats_.conflicts >= options_.max_conflicts) return true;
+    if (options_.deadline != std::chrono::steady_clock::time_point::max() &&
+        std::chrono::steady_clock::now() >= options_.deadline) return true;
+    return false;
+}
+
+// Same graph as the snapshot: vertex count, row offsets and neighbors
+uint64_t CdclSolver::graph_fingerprint() {
+    if (graph_hash_ == 0) {
+        const std::vector<int64_t>& offsets = adj_.offsets();
+        const std::vector<int>& targets = adj_.targets();
+        graph_hash_ = checkpoint_hash(offsets.data(), offsets.size() * sizeof(int64_t));
+        graph_hash_ = checkpoint_hash(targets.data(), targets.size() * sizeof(int), graph_hash_);
+    }
+    return graph_hash_;
+}
+
+// Only called at level 0, where the trail holds nothing but implied facts
+void CdclSolver::save_checkpoint() {
+    std::string& out = options_.checkpoint->begin();
+    put_value<int32_t>(out, n_);
+    put_value(out, graph_fingerprint());
+    put_value(out, stats_);
+    put_value(out, restart_index_);
+    put_value(out, conflicts_until_restart_);
+    put_value(out, activity_inc_);
+    put_value(out, clause_inc_);
+    put_value<int32_t>(out, learned_limit_);
+    put_vector(out, activity_);
+    put_vector(out, phase_);
+    put_vector(out, trail_);
+
+    put_value<uint64_t>(out, learned_.size());
+    for (int ci : learned_) {
+        const Clause& cl = clauses_[ci];
+        put_value<int32_t>(out, cl.lbd);
+        put_value(out, cl.activity);
+        put_vector(out, cl.lits);
+    }
+    options_.checkpoint->commit(CheckpointKind::CDCL);
+}
+
+void CdclSolver::resume(const std::string& snapshot) {
+    if (stats_.conflicts > 0 || !trail_.empty()) {
+        throw std::logic_error("CdclSolver::resume must be called before solve()");
+    }
+    SnapshotReader in(snapshot);
+    if (in.get<int32_t>() != n_ || in.get<uint64_t>() != graph_fingerprint()) {
+        throw std::runtime_error("Checkpoint was written for a different graph");
+    }
+    CdclStats stats = in.get<CdclStats>();
+    uint64_t restart_index = in.get<uint64_t>();
+    uint64_t conflicts_until_restart = in.get<uint64_t>();
+    double activity_inc = in.get<double>();
+    double clause_inc = in.get<double>();
+    int learned_limit = in.get<int32_t>();
+    std::vector<double> activity = in.get_vector<double>();
+    std::vector<int8_t> phase = in.get_vector<int8_t>();
+    std::vector<int> units = in.get_vector<int>();
+    if (activity.size() != static_cast<size_t>(n_) || phase.size() != static_cast<size_t>(n_)) {
+        throw std::runtime_error("Damaged CDCL checkpoint");
+    }
+
+    std::vector<Clause> learned(in.get<uint64_t>());
+    const int lit_limit = 6 * n_;
+    for (Clause& cl : learned) {
+        cl.lbd = in.get<int32_t>();
+        cl.activity = in.get<double>();
+        cl.lits = in.get_vector<int>();
+        cl.deleted = false;
+        for (int lit : cl.lits) {
+            if (lit < 0 || lit >= lit_limit) throw std::runtime_error("Damaged CDCL checkpoint");
+        }
+        if (cl.lits.size() < 2) throw std::runtime_error("Damaged CDCL checkpoint");
+    }
+    if (!in.at_end()) throw std::runtime_error("Damaged CDCL checkpoint");
+
+    stats_ = stats;
+    restart_index_ = restart_index;
+    conflicts_until_restart_ = conflicts_until_restart;
+    activity_inc_ = activity_inc;
+    clause_inc_ = clause_inc;
+    learned_limit_ = learned_limit;
+    activity_ = activity;
+    phase_ = phase;
+
+    heap_.clear();
+    heap_index_.assign(n_, -1);
+    for (int v = 0; v < n_; ++v) heap_insert(v);
+
+    // watches only; solve() propagates the units below through them
+    for (Clause& cl : learned) {
+        int index = static_cast<int>(clauses_.size());
+        watches_[cl.lits[0]].push_back(index);
+        watches_[cl.lits[1]].push_back(index);
+        learned_.push_back(index);
+        clauses_.push_back(std::move(cl));
+    }
+    for (int lit : units) {
+        if (lit < 0 || lit >= lit_limit || !enqueue(lit, Reason{REASON_NONE, 0})) {
+            throw std::runtime_error("Damaged CDCL checkpoint");
+        }
+    }
+}
+
+// Makes lit true; returns false if it is already false
+bool CdclSolver::enqueue(int lit, Reason why) {
+    int current = lit_value(lit);
+    if (current == 1) return true;
+    if (current == 0) return false;
+
+    int var = var_of(lit);
+    value_[var] = static_cast<int8_t>((lit & 1) ^ 1);
+    level_[var] = decision_level();
+    reason_[var] = why;
+    trail_.push_back(lit);
+
+    int v = vertex_of_var(var);
+    int c = color_of_var(var);
+    if (lit & 1) forbidden_mask_[v] = static_cast<uint8_t>(forbidden_mask_[v] | (1 << c));
+    else color_[v] = static_cast<int8_t>(c);
+    return true;
+}
+
+// Returns false and fills conflict_ (all false literals) on a conflict
+bool CdclSolver::propagate() {
+    while (qhead_ < trail_.size()) {
+        int p = trail_[qhead_++];
+        ++stats_.propagations;
+        int var = var_of(p);
+        int v = vertex_of_var(var);
+        int c = color_of_var(var);
+
+        if (!(p & 1)) {
+            // v took color c: no other color for v, and no c for its neighbors
+            for (int d = 0; d < 3; ++d) {
+                if (d == c) continue;
+                int q = negate(positive(v, d));
+                if (!enqueue(q, Reason{REASON_BINARY, p})) {
+                    conflict_.assign({negate(p), q});
+                    return false;
+                }
+            }
+            for (const int* w = adj_.begin(v); w != adj_.end(v); ++w) {
+                int q = negate(positive(*w, c));
+                if (!enqueue(q, Reason{REASON_BINARY, p})) {
+                    conflict_.assign({negate(p), q});
+                    return false;
+                }
+            }
+        } else if (color_[v] < 0) {
+            // c ruled out for v: check what is left of its domain
+            uint8_t mask = forbidden_mask_[v];
+            if (mask == 0b111) {
+                conflict_.assign({positive(v, 0), positive(v, 1), positive(v, 2)});
+                return false;
+            }
+            if (mask == 0b011 || mask == 0b101 || mask == 0b110) {
+                int last = (mask & 1) == 0 ? 0 : ((mask & 2) == 0 ? 1 : 2);
+                enqueue(positive(v, last), Reason{REASON_DOMAIN, v});
+            }
+        }
+
+        // learned clauses watching the literal that just became false
+        int f = negate(p);
+        std::vector<int>& ws = watches_[f];
+        size_t i = 0, j = 0;
+        while (i < ws.size()) {
+            int ci = ws[i++];
+            Clause& cl = clauses_[ci];
+            if (cl.deleted) continue; // drop stale watch
+
+            std::vector<int>& lits = cl.lits;
+            if (lits[0] == f) std::swap(lits[0], lits[1]);
+            if (lit_value(lits[0]) == 1) {
+                ws[j++] = ci;
+                continue;
+            }
+
+            bool moved = false;
+            for (size_t k = 2; k < lits.size(); ++k) {
+                if (lit_value(lits[k]) != 0) {
+                    std::swap(lits[1], lits[k]);
+                    watches_[lits[1]].push_back(ci);
+                    moved = true;
+                    break;
+                }
+            }
+            if (moved) continue;
+
+            ws[j++] = ci;
+            if (lit_value(lits[0]) == 0) {
+                conflict_ = lits;
+                while (i < ws.size()) ws[j++] = ws[i++];
+                ws.resize(j);
+                return false;
+            }
+            enqueue(lits[0], Reason{REASON_CLAUSE, ci});
+        }
+        ws.resize(j);
+    }
+    return true;
+}
+
+// The false literals of the clause that implied var
+void CdclSolver::reason_literals(int var, std::vector<int>& out) const {
+    out.clear();
+    const Reason& r = reason_[var];
+    int implied = 2 * var + (value_[var] == 0 ? 1 : 0);
+    switch (r.kind) {
+        case REASON_BINARY:
+            out.push_back(negate(r.data));
+            break;
+        case REASON_DOMAIN:
+            for (int d = 0; d < 3; ++d) {
+                if (d != color_of_var(var)) out.push_back(positive(r.data, d));
+            }
+            break;
+        case REASON_CLAUSE:
+            for (int lit : clauses_[r.data].lits) {
+                if (lit != implied) out.push_back(lit);
+            }
+            break;
+        case REASON_NONE:
+            break;
+    }
+}
+
+// First-UIP learning; leaves the clause in learnt_ with the asserting literal first
+void CdclSolver::analyze(int& backtrack_level) {
+    learnt_.assign(1, -1);
+    std::vector<int> clause = conflict_;
+    int path = 0;
+    int p = -1;
+    int index = static_cast<int>(trail_.size()) - 1;
+
+    while (true) {
+        for (int q : clause) {
+            int x = var_of(q);
+            if (seen_[x] || level_[x] == 0) continue;
+            seen_[x] = 1;
+            bump_vertex(vertex_of_var(x));
+            if (level_[x] >= decision_level()) ++path;
+            else learnt_.push_back(q);
+        }
+
+        // next literal of the current level on the trail
+        while (!seen_[var_of(trail_[index])]) --index;
+        p = trail_[index--];
+        seen_[var_of(p)] = 0;
+        if (--path == 0) break;
+
+        if (reason_[var_of(p)].kind == REASON_CLAUSE) bump_clause(reason_[var_of(p)].data);
+        reason_literals(var_of(p), clause);
+    }
+    learnt_[0] = negate(p);
+
+    backtrack_level = 0;
+    int max_index = 1;
+    for (size_t i = 1; i < learnt_.size(); ++i) {
+        int x = var_of(learnt_[i]);
+        seen_[x] = 0;
+        if (level_[x] > backtrack_level) {
+            backtrack_level = level_[x];
+            max_index = static_cast<int>(i);
+        }
+    }
+    if (learnt_.size() > 1) std::swap(learnt_[1], learnt_[max_index]);
+}
+
+void CdclSolver::backtrack(int level) {
+    if (decision_level() <= level) return;
+
+    for (int i = static_cast<int>(trail_.size()) - 1; i >= trail_lim_[level]; --i) {
+        int lit = trail_[i];
+        int var = var_of(lit);
+        int v = vertex_of_var(var);
+        int c = color_of_var(var);
+        value_[var] = -1;
+        reason_[var] = Reason{REASON_NONE, 0};
+
+        if (lit & 1) {
+            forbidden_mask_[v] = static_cast<uint8_t>(forbidden_mask_[v] & ~(1 << c));
+        } else {
+            phase_[v] = static_cast<int8_t>(c);
+            // another color of v may still be true on a lower level
+            color_[v] = -1;
+            for (int d = 0; d < 3; ++d) {
+                if (value_[3 * v + d] == 1) color_[v] = static_cast<int8_t>(d);
+            }
+            if (color_[v] < 0) heap_insert(v);
+        }
+    }
+    trail_.resize(trail_lim_[level]);
+    trail_lim_.resize(level);
+    qhead_ = trail_.size();
+}
+
+// Most active uncolored vertex with its saved color, else RED -> BLUE -> YELLOW
+int CdclSolver::pick_decision() {
+    while (!heap_.empty()) {
+        int v = heap_pop();
+        if (color_[v] >= 0) continue;
+
+        int saved = phase_[v];
+        if (saved >= 0 && !(forbidden_mask_[v] & (1 << saved))) return positive(v, saved);
+        for (int c = 0; c < 3; ++c) {
+            if (!(forbidden_mask_[v] & (1 << c))) return positive(v, c);
+        }
+    }
+    return -1;
+}
+
+void CdclSolver::add_learned(const std::vector<int>& lits) {
+    // LBD: number of distinct decision levels in the clause
+    ++lbd_counter_;
+    int lbd = 0;
+    for (int lit : lits) {
+        int lvl = level_[var_of(lit)];
+        if (lbd_stamp_[lvl] != lbd_counter_) {
+            lbd_stamp_[lvl] = lbd_counter_;
+            ++lbd;
+        }
+    }
+
+    int index = static_cast<int>(clauses_.size());
+    clauses_.push_back(Clause{lits, 0.0, lbd, false});
+    watches_[lits[0]].push_back(index);
+    watches_[lits[1]].push_back(index);
+    learned_.push_back(index);
+    bump_clause(index);
+    ++stats_.learned;
+}
+
+// Drop the worse half of the learned clauses, keeping glue clauses (LBD <= 2)
+// and any clause that is currently the reason for an assignment
+void CdclSolver::reduce_learned() {
+    std::sort(learned_.begin(), learned_.end(), [&](int a, int b) {
+        const Clause& ca = clauses_[a];
+        const Clause& cb = clauses_[b];
+        if (ca.lbd != cb.lbd) return ca.lbd < cb.lbd;
+        return ca.activity > cb.activity;
+    });
+
+    size_t keep = learned_.size() / 2;
+    size_t j = 0;
+    for (size_t i = 0; i < learned_.size(); ++i) {
+        int ci = learned_[i];
+        Clause& cl = clauses_[ci];
+        int first = var_of(cl.lits[0]);
+        bool locked = reason_[first].kind == REASON_CLAUSE && reason_[first].data == ci && value_[first] != -1;
+
+        if (i < keep || cl.lbd <= 2 || locked) {
+            learned_[j++] = ci;
+        } else {
+            cl.deleted = true;
+            std::vector<int>().swap(cl.lits);
+            ++stats_.deleted;
+        }
+    }
+    learned_.resize(j);
+}
+
+void CdclSolver::write_back() {
+    graph_.reset_coloring_state();
+    for (int v = 0; v < n_; ++v) {
+        Vertex& vert = graph_.vertex(v);
+        vert.color = static_cast<Color>(color_[v]);
+        vert.forbidden_mask = forbidden_mask_[v];
+    }
+}
+
+void CdclSolver::bump_vertex(int v) {
+    activity_[v] += activity_inc_;
+    if (activity_[v] > 1e100) {
+        for (double& a : activity_) a *= 1e-100;
+        activity_inc_ *= 1e-100;
+    }
+    if (heap_index_[v] >= 0) heap_up(heap_index_[v]);
+}
+
+void CdclSolver::bump_clause(int index) {
+    Clause& cl = clauses_[index];
+    cl.activity += clause_inc_;
+    if (cl.activity > 1e20) {
+        for (int ci : learned_) clauses_[ci].activity *= 1e-20;
+        clause_inc_ *= 1e-20;
+    }
+}
+
+void CdclSolver::heap_insert(int v) {
+    if (heap_index_[v] >= 0) return;
+    heap_index_[v] = static_cast<int>(heap_.size());
+    heap_.push_back(v);
+    heap_up(heap_index_[v]);
+}
+
+int CdclSolver::heap_pop() {
+    int top = heap_[0];
+    heap_index_[top] = -1;
+    int last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        heap_[0] = last;
+        heap_index_[last] = 0;
+        heap_down(0);
+    }
+    return top;
+}
+
+void CdclSolver::heap_up(int i) {
+    int v = heap_[i];
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (activity_[heap_[parent]] >= activity_[v]) break;
+        heap_[i] = heap_[parent];
+        heap_index_[heap_[i]] = i;
+        i = parent;
+    }
+    heap_[i] = v;
+    heap_index_[v] = i;
+}
+
+void CdclSolver::heap_down(int i) {
+    int v = heap_[i];
+    int size = static_cast<int>(heap_.size());
+    while (true) {
+        int child = 2 * i + 1;
+        if (child >= size) break;
+        if (child + 1 < size && activity_[heap_[child + 1]] > activity_[heap_[child]]) ++child;
+        if (activity_[heap_[child]] <= activity_[v]) break;
+        heap_[i] = heap_[child];
+        heap_index_[heap_[i]] = i;
+        i = child;
+    }
+    heap_[i] = v;
+    heap_index_[v] = i;
+}
+
+} // namespace threecolor
@@ -0,0 +1,220 @@
+/*
+checkpoint.cpp
+
+Author: Dialo Sall
+
+Implementation of checkpoint.hpp
+Double-buffered like trace.cpp: the run fills one buffer while the writer
+thread puts the other one on disk with write, fsync, rename and a directory fsync
+*/
+#include "checkpoint.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace threecolor {
+
+namespace {
+
+    constexpr uint32_t kCheckpointVersion = 1;
+
+    // fsync the directory holding path, so a rename into it survives a crash
+    bool sync_parent_directory(const std::string& path) {
+        size_t slash = path.find_last_of('/');
+        const std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0) return false;
+        bool ok = ::fsync(fd) == 0;
+        if (::close(fd) != 0) ok = false;
+        return ok;
+    }
+
+    // path.tmp, fsync, rename over path, fsync the directory; false (and no
+    // path.tmp left) on any error
+    bool write_atomically(const std::string& path, const std::string& data) {
+        const std::string tmp = path + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+
+        bool ok = true;
+        size_t done = 0;
+        while (ok && done < data.size()) {
+            ssize_t wrote = ::write(fd, data.data() + done, data.size() - done);
+            if (wrote < 0 && errno == EINTR) continue;
+            if (wrote <= 0) ok = false;
+            else done += static_cast<size_t>(wrote);
+        }
+        if (ok && ::fsync(fd) != 0) ok = false;
+        if (::close(fd) != 0) ok = false;
+        if (ok && std::rename(tmp.c_str(), path.c_str()) != 0) ok = false;
+        if (!ok) {
+            std::remove(tmp.c_str());
+            return false;
+        }
+        // the new snapshot is in place, but it is not durable until the directory is
+        return sync_parent_directory(path);
+    }
+
+} // namespace
+
+uint64_t checkpoint_hash(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path, const CheckpointOptions& options)
+    : path_(path), options_(options), start_(Clock::now()), serialize_start_(start_),
+      active_index_(0), pending_index_(-1), pending_serialize_(0.0), last_cost_(0.0),
+      next_due_(start_ + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(options.interval_seconds))),
+      stats_{0, 0, 0, 0.0, 0.0, 0.0, 0.0}, stopping_(false), closed_(false)
+{
+    writer_ = std::thread(&CheckpointWriter::writer_loop, this);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    close();
+}
+
+bool CheckpointWriter::due() {
+    Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_ || pending_index_ != -1 || now < next_due_) return false;
+    if (options_.max_overhead_percent <= 0) return true;
+    // the total so far plus another snapshot like the last must stay in budget
+    double spent = stats_.serialize_seconds + stats_.write_seconds + last_cost_;
+    double run = std::chrono::duration<double>(now - start_).count();
+    return spent * 100.0 <= options_.max_overhead_percent * run;
+}
+
+std::string& CheckpointWriter::begin() {
+    serialize_start_ = Clock::now();
+    std::string& buffer = buffers_[active_index_];
+    buffer.assign(sizeof(CheckpointHeader), '\0');
+    return buffer;
+}
+
+void CheckpointWriter::commit(CheckpointKind kind) {
+    std::string& buffer = buffers_[active_index_];
+    CheckpointHeader header;
+    std::memcpy(header.magic, "3CCK", 4);
+    header.version = kCheckpointVersion;
+    header.kind = static_cast<uint32_t>(kind);
+    header.reserved = 0;
+    header.payload_size = buffer.size() - sizeof(CheckpointHeader);
+    header.checksum = checkpoint_hash(buffer.data() + sizeof(CheckpointHeader), header.payload_size);
+    std::memcpy(&buffer[0], &header, sizeof(header));
+    double seconds = std::chrono::duration<double>(Clock::now() - serialize_start_).count();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (closed_) return;
+    // only blocks if the writer is still busy with the previous snapshot
+    cv_.wait(lock, [this] { return pending_index_ == -1; });
+    pending_index_ = active_index_;
+    pending_serialize_ = seconds;
+    stats_.serialize_seconds += seconds;
+    cv_.notify_all();
+    active_index_ ^= 1;
+}
+
+void CheckpointWriter::writer_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return pending_index_ != -1 || stopping_; });
+        if (pending_index_ == -1) break; // stopping with nothing left
+
+        int index = pending_index_;
+
+        // the buffer stays owned by the writer until pending_index_ is cleared
+        lock.unlock();
+        Clock::time_point start = Clock::now();
+        bool ok = write_atomically(path_, buffers_[index]);
+        Clock::time_point end = Clock::now();
+        lock.lock();
+
+        double seconds = std::chrono::duration<double>(end - start).count();
+        stats_.write_seconds += seconds;
+        if (ok) {
+            ++stats_.snapshots;
+            stats_.last_bytes = buffers_[index].size();
+        } else {
+            ++stats_.failures;
+        }
+
+        last_cost_ = pending_serialize_ + seconds;
+        double wait = options_.interval_seconds;
+        if (options_.max_overhead_percent > 0) {
+            wait = std::max(wait, last_cost_ * 100.0 / options_.max_overhead_percent);
+        }
+        next_due_ = end + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(wait));
+        pending_index_ = -1;
+        cv_.notify_all();
+    }
+}
+
+void CheckpointWriter::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) return;
+        closed_ = true;
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    writer_.join();
+}
+
+void CheckpointWriter::discard() {
+    close();
+    std::remove(path_.c_str());
+}
+
+CheckpointStats CheckpointWriter::stats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CheckpointStats st = stats_;
+    st.run_seconds = std::chrono::duration<double>(Clock::now() - start_).count();
+    st.overhead_percent = st.run_seconds > 0
+        ? (st.serialize_seconds + st.write_seconds) * 100.0 / st.run_seconds : 0.0;
+    return st;
+}
+
+bool load_checkpoint(const std::string& path, CheckpointKind kind, std::string& payload) {
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        if (errno == ENOENT) return false;
+        throw std::runtime_error("Could not open checkpoint file: " + path);
+    }
+
+    std::string data;
+    char chunk[1 << 16];
+    size_t got;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), in)) > 0) data.append(chunk, got);
+    bool read_error = std::ferror(in) != 0;
+    std::fclose(in);
+
+    CheckpointHeader header;
+    if (read_error || data.size() < sizeof(header)) {
+        throw std::runtime_error("Damaged checkpoint file: " + path);
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, "3CCK", 4) != 0 || header.version != kCheckpointVersion) {
+        throw std::runtime_error("Not a 3-color checkpoint file: " + path);
+    }
+    if (header.kind != static_cast<uint32_t>(kind)) {
+        throw std::runtime_error("Checkpoint file holds another kind of snapshot: " + path);
+    }
+    if (header.payload_size != data.size() - sizeof(header)
+        || header.checksum != checkpoint_hash(data.data() + sizeof(header), header.payload_size)) {
+        throw std::runtime_error("Damaged checkpoint file: " + path);
+    }
+    payload = data.substr(sizeof(header));
+    return true;
+}
+
+} // namespace threecolor
@@ -0,0 +1,63 @@
+/*
+compressed_adjacency.cpp
+
+Author: Dialo Sall
+
+Implementation of compressed_adjacency.hpp
+
+Two passes over the rows: the first sizes every encoded row, so the second
+writes into a buffer allocated once at its exact size
+*/
+#include "compressed_adjacency.hpp"
+
+namespace threecolor {
+
+int CompressedAdjacency::varint_size(uint32_t value) {
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+uint8_t* CompressedAdjacency::write_varint(uint8_t* out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+CompressedAdjacency::CompressedAdjacency(const std::vector<int64_t>& offsets, const std::vector<int>& targets)
+    : row_start_(offsets.size(), 0)
+{
+    const int n = static_cast<int>(offsets.size()) - 1;
+
+    // descending row: largest id first, then the gaps down to the smallest
+    for (int v = 0; v < n; ++v) {
+        uint64_t size = 0;
+        int64_t b = offsets[v], e = offsets[v + 1];
+        if (e > b) {
+            size += varint_size(static_cast<uint32_t>(targets[e - 1]));
+            for (int64_t i = e - 1; i > b; --i) {
+                size += varint_size(static_cast<uint32_t>(targets[i] - targets[i - 1]));
+            }
+        }
+        row_start_[v + 1] = row_start_[v] + size;
+    }
+
+    data_.resize(row_start_[n]);
+    for (int v = 0; v < n; ++v) {
+        uint8_t* out = data_.data() + row_start_[v];
+        int64_t b = offsets[v], e = offsets[v + 1];
+        if (e == b) continue;
+        out = write_varint(out, static_cast<uint32_t>(targets[e - 1]));
+        for (int64_t i = e - 1; i > b; --i) {
+            out = write_varint(out, static_cast<uint32_t>(targets[i] - targets[i - 1]));
+        }
+    }
+}
+
+} // namespace threecolor
@@ -0,0 +1,170 @@
+/*
+csr_graph.cpp
+
+Author: Dialo Sall
+
+Implementation of csr_graph.hpp
+*/
+#include "csr_graph.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace threecolor {
+
+namespace {
+
+    constexpr int64_t kVertexChunk = 1 << 12;
+
+    // Vertices per scatter block (2^14): a block's row cursors fit in cache,
+    // so scattering a block touches memory sequentially instead of at random
+    constexpr int kBlockBits = 14;
+
+} // namespace
+
+CsrGraph CsrGraph::from_edges(int n, const std::vector<Edge>& edges, int threads, CsrBuildStats* stats) {
+    if (n < 0) throw std::out_of_range("CsrGraph: negative vertex count");
+    if (threads <= 0) threads = default_thread_count();
+    const int64_t m = static_cast<int64_t>(edges.size());
+    const int64_t blocks = (static_cast<int64_t>(n) >> kBlockBits) + 1;
+    const int64_t slice = (m + threads - 1) / threads;
+
+    // 1. count the entries each thread's slice of edges sends to each vertex block
+    std::vector<int64_t> sent(static_cast<size_t>(threads) * blocks, 0); // [thread][block]
+    std::vector<uint64_t> loops(threads, 0);
+    std::atomic<bool> out_of_range(false);
+    run_on_threads(threads, [&](int t) {
+        int64_t* row = sent.data() + static_cast<size_t>(t) * blocks;
+        for (int64_t i = t * slice; i < std::min(m, (t + 1) * slice); ++i) {
+            int u = edges[i].u, v = edges[i].v;
+            if (u < 0 || v < 0 || u >= n || v >= n) {
+                out_of_range.store(true, std::memory_order_relaxed);
+                continue;
+            }
+            if (u == v) {
+                ++loops[t];
+                continue;
+            }
+            ++row[u >> kBlockBits];
+            ++row[v >> kBlockBits];
+        }
+    });
+    if (out_of_range.load()) throw std::out_of_range("CsrGraph: edge endpoint out of range");
+
+    // 2. stage both directions of every edge grouped by the block of their source;
+    //    each block's entries end up contiguous, in input order
+    std::vector<int64_t> block_start;
+    parallel_exclusive_scan(blocks * threads, 1, block_start, [&](int64_t i) {
+        int64_t b = i / threads, t = i % threads;
+        return sent[static_cast<size_t>(t) * blocks + b];
+    });
+    std::vector<Edge> staged(block_start.back());
+    run_on_threads(threads, [&](int t) {
+        std::vector<int64_t> cursor(blocks);
+        for (int64_t b = 0; b < blocks; ++b) cursor[b] = block_start[b * threads + t];
+        for (int64_t i = t * slice; i < std::min(m, (t + 1) * slice); ++i) {
+            int u = edges[i].u, v = edges[i].v;
+            if (u == v) continue;
+            staged[cursor[u >> kBlockBits]++] = Edge{u, v};
+            staged[cursor[v >> kBlockBits]++] = Edge{v, u};
+        }
+    });
+
+    // 3. degrees, then offsets; one thread owns a block, so no atomics
+    std::vector<int64_t> counts(n, 0);
+    parallel_for_chunks(0, blocks, 1, threads, [&](int64_t b, int64_t e, int) {
+        for (int64_t i = block_start[b * threads]; i < block_start[e * threads]; ++i) ++counts[staged[i].u];
+    });
+    std::vector<int64_t> offsets;
+    parallel_exclusive_scan(n, threads, offsets, [&](int64_t v) { return counts[v]; });
+
+    // 4. scatter each block into its rows; the block's cursors stay in cache
+    std::vector<int> targets(offsets[n]);
+    parallel_for_chunks(0, blocks, 1, threads, [&](int64_t b, int64_t e, int) {
+        for (int64_t i = block_start[b * threads]; i < block_start[e * threads]; ++i) {
+            int u = staged[i].u;
+            targets[offsets[u] + --counts[u]] = staged[i].v;
+        }
+    });
+    std::vector<Edge>().swap(staged);
+
+    // 5. sort, unique, compact
+    CsrGraph csr = finish_rows(offsets, targets, threads);
+
+    if (stats) {
+        stats->input_edges = static_cast<uint64_t>(m);
+        stats->self_loops = 0;
+        for (uint64_t l : loops) stats->self_loops += l;
+        stats->duplicate_edges = static_cast<uint64_t>(m) - stats->self_loops - csr.num_edges();
+    }
+    return csr;
+}
+
+CsrGraph CsrGraph::from_graph(const Graph& g, int threads) {
+    if (threads <= 0) threads = default_thread_count();
+    const int n = g.num_vertices();
+
+    std::vector<int64_t> offsets;
+    parallel_exclusive_scan(n, threads, offsets, [&](int64_t v) {
+        int64_t count = 0;
+        g.for_each_neighbor(static_cast<int>(v), [&](int) { ++count; return true; });
+        return count;
+    });
+
+    std::vector<int> targets(offsets[n]);
+    parallel_for_chunks(0, n, kVertexChunk, threads, [&](int64_t b, int64_t e, int) {
+        for (int64_t v = b; v < e; ++v) {
+            int64_t pos = offsets[v];
+            g.for_each_neighbor(static_cast<int>(v), [&](int w) { targets[pos++] = w; return true; });
+        }
+    });
+
+    return finish_rows(offsets, targets, threads);
+}
+
+CsrGraph CsrGraph::finish_rows(std::vector<int64_t>& offsets, std::vector<int>& targets, int threads) {
+    const int n = static_cast<int>(offsets.size()) - 1;
+
+    std::vector<int64_t> unique_counts(n);
+    parallel_for_chunks(0, n, kVertexChunk, threads, [&](int64_t b, int64_t e, int) {
+        for (int64_t v = b; v < e; ++v) {
+            int* row_begin = targets.data() + offsets[v];
+            int* row_end = targets.data() + offsets[v + 1];
+            std::sort(row_begin, row_end);
+            unique_counts[v] = std::unique(row_begin, row_end) - row_begin;
+        }
+    });
+
+    CsrGraph csr;
+    parallel_exclusive_scan(n, threads, csr.offsets_, [&](int64_t v) { return unique_counts[v]; });
+    if (csr.offsets_[n] == offsets[n]) {
+        // nothing removed: the scattered array already is the final one
+        csr.targets_.swap(targets);
+        return csr;
+    }
+
+    csr.targets_.resize(csr.offsets_[n]);
+    parallel_for_chunks(0, n, kVertexChunk, threads, [&](int64_t b, int64_t e, int) {
+        for (int64_t v = b; v < e; ++v) {
+            std::copy(targets.begin() + offsets[v], targets.begin() + offsets[v] + unique_counts[v],
+                      csr.targets_.begin() + csr.offsets_[v]);
+        }
+    });
+    return csr;
+}
+
+Graph CsrGraph::to_graph() const {
+    const int n = num_vertices();
+    Graph g(n);
+    // increasing (u, v) so add_edge leaves every list in descending id order
+    for (int u = 0; u < n; ++u) {
+        for (const int* p = begin(u); p != end(u); ++p) {
+            if (*p > u) g.add_edge(u, *p);
+        }
+    }
+    g.compute_degrees();
+    return g;
+}
+
+} // namespace threecolor
@@ -0,0 +1,248 @@
+/*
+dense_solver.cpp
+
+Author: Dialo Sall
+
+Implementation of dense_solver.hpp
+
+Coloring vertex v with color c:
+    1. changed  = row(v) & uncolored & allowed[c]   (neighbors that lose c)
+       allowed[c] &= ~(row(v) & uncolored)          (AVX2 when the CPU has it)
+    2. every uncolored neighbor gets one more colored neighbor
+    3. among the changed vertices, no allowed color left is a contradiction
+       and exactly one allowed color means trapped
+*/
+#include "dense_solver.hpp"
+#include <algorithm>
+#include <numeric>
+
+// The AVX2 loop is built with a target attribute, so it does not need -mavx2
+#if defined(__x86_64__) || defined(__i386__)
+#define THREECOLOR_DENSE_AVX2 1
+#include <immintrin.h>
+#else
+#define THREECOLOR_DENSE_AVX2 0
+#endif
+
+namespace threecolor {
+
+namespace {
+
+    inline int highest_bit(uint64_t x) {
+        return 63 - __builtin_clzll(x);
+    }
+
+#if THREECOLOR_DENSE_AVX2
+    // Step 1 four words at a time; returns how many words it did
+    __attribute__((target("avx2")))
+    int update_masks_avx2(const uint64_t* r, const uint64_t* uncolored, uint64_t* allowed_c,
+                          uint64_t* changed, int words) {
+        int w = 0;
+        for (; w + 4 <= words; w += 4) {
+            __m256i row_v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(r + w));
+            __m256i open = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(uncolored + w));
+            __m256i allow = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(allowed_c + w));
+            __m256i nbrs = _mm256_and_si256(row_v, open);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(changed + w), _mm256_and_si256(nbrs, allow));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(allowed_c + w), _mm256_andnot_si256(nbrs, allow));
+        }
+        return w;
+    }
+#endif
+
+} // namespace
+
+DenseSolver::DenseSolver(Graph& g)
+    : graph_(g),
+      n_(g.num_vertices()),
+      words_((g.num_vertices() + 63) / 64),
+      use_avx2_(avx2_available()),
+      order_start_(0)
+{
+    adjacency_.assign(static_cast<size_t>(n_) * words_, 0);
+    for (int v = 0; v < n_; ++v) {
+        uint64_t* r = adjacency_.data() + static_cast<size_t>(v) * words_;
+        g.for_each_neighbor(v, [&](int u) {
+            r[u >> 6] |= (1ULL << (u & 63));
+            return true;
+        });
+    }
+
+    for (auto& bits : allowed_) bits.assign(words_, 0);
+    uncolored_.assign(words_, 0);
+    changed_.assign(words_, 0);
+    color_.assign(n_, -1);
+    colored_neighbors_.assign(n_, 0);
+    is_trapped_.assign(n_, 0);
+    trapped_.reserve(n_);
+
+    // Matches the sorting machine: degree descending, then id ascending
+    order_.resize(n_);
+    std::iota(order_.begin(), order_.end(), 0);
+    std::stable_sort(order_.begin(), order_.end(), [&](int a, int b) {
+        return g.vertex(a).degree > g.vertex(b).degree;
+    });
+}
+
+bool DenseSolver::prefers_dense(const Graph& g) {
+    int n = g.num_vertices();
+    if (n < 2 || n > kMaxVertices) return false;
+
+    long long degree_sum = 0;
+    for (int i = 0; i < n; ++i) degree_sum += g.vertex(i).degree;
+    double density = static_cast<double>(degree_sum) / (static_cast<double>(n) * (n - 1));
+    return density >= kDensityThreshold;
+}
+
+bool DenseSolver::avx2_available() {
+#if THREECOLOR_DENSE_AVX2
+    static const bool available = __builtin_cpu_supports("avx2");
+    return available;
+#else
+    return false;
+#endif
+}
+
+void DenseSolver::initialize_state() {
+    // every vertex uncolored and allowed every color; bits past n_ stay zero
+    for (int w = 0; w < words_; ++w) {
+        int valid = std::min(64, n_ - w * 64);
+        uint64_t mask = valid == 64 ? ~0ULL : ((1ULL << valid) - 1);
+        uncolored_[w] = mask;
+        for (auto& bits : allowed_) bits[w] = mask;
+    }
+    std::fill(color_.begin(), color_.end(), -1);
+    std::fill(colored_neighbors_.begin(), colored_neighbors_.end(), 0);
+    std::fill(is_trapped_.begin(), is_trapped_.end(), 0);
+    trapped_.clear();
+    order_start_ = 0;
+}
+
+bool DenseSolver::run_greedy() {
+    initialize_state();
+
+    for (int remaining = n_; remaining > 0; --remaining) {
+        // 1. Trapped vertex first
+        int v = -1;
+        while (!trapped_.empty()) {
+            int t = trapped_.back();
+            trapped_.pop_back();
+            is_trapped_[t] = 0;
+            if (is_uncolored(t)) {
+                v = t;
+                break;
+            }
+        }
+        // 2. Else highest priority uncolored vertex
+        if (v < 0) v = pick_next_vertex();
+
+        int c = choose_color(v);
+        if (c < 0 || !color_vertex(v, c)) {
+            write_back();
+            return false;
+        }
+    }
+
+    write_back();
+    return true;
+}
+
+// Highest degree, then most colored neighbors, then lowest id
+int DenseSolver::pick_next_vertex() {
+    while (color_[order_[order_start_]] != -1) ++order_start_;
+
+    int degree = graph_.vertex(order_[order_start_]).degree;
+    int best = -1;
+    for (int i = order_start_; i < n_; ++i) {
+        int v = order_[i];
+        if (graph_.vertex(v).degree != degree) break;
+        if (color_[v] == -1 && (best < 0 || colored_neighbors_[v] > colored_neighbors_[best])) {
+            best = v;
+        }
+    }
+    return best;
+}
+
+// RED, then BLUE, then YELLOW
+int DenseSolver::choose_color(int v) const {
+    for (int c = 0; c < 3; ++c) {
+        if ((allowed_[c][v >> 6] >> (v & 63)) & 1ULL) return c;
+    }
+    return -1;
+}
+
+bool DenseSolver::color_vertex(int v, int c) {
+    color_[v] = static_cast<int8_t>(c);
+    uncolored_[v >> 6] &= ~(1ULL << (v & 63));
+
+    const uint64_t* r = row(v);
+    uint64_t* allowed_c = allowed_[c].data();
+    uint64_t* changed = changed_.data();
+    const uint64_t* uncolored = uncolored_.data();
+
+    // 1. word-parallel mask update
+    int w = 0;
+#if THREECOLOR_DENSE_AVX2
+    if (use_avx2_) w = update_masks_avx2(r, uncolored, allowed_c, changed, words_);
+#endif
+    for (; w < words_; ++w) {
+        uint64_t nbrs = r[w] & uncolored[w];
+        changed[w] = nbrs & allowed_c[w];
+        allowed_c[w] &= ~nbrs;
+    }
+
+    // 2. colored-neighbor counts feed the pick order
+    for (w = 0; w < words_; ++w) {
+        uint64_t nbrs = r[w] & uncolored[w];
+        while (nbrs) {
+            int bit = __builtin_ctzll(nbrs);
+            ++colored_neighbors_[w * 64 + bit];
+            nbrs &= nbrs - 1;
+        }
+    }
+
+    // 3. contradictions and newly trapped vertices, highest id first so the
+    //    lowest id ends up on top of the stack like the sparse path
+    const uint64_t* a0 = allowed_[RED].data();
+    const uint64_t* a1 = allowed_[BLUE].data();
+    const uint64_t* a2 = allowed_[YELLOW].data();
+    for (w = words_ - 1; w >= 0; --w) {
+        uint64_t ch = changed[w];
+        if (!ch) continue;
+
+        uint64_t any = a0[w] | a1[w] | a2[w];
+        if (ch & ~any) return false;
+
+        uint64_t exactly_one = (a0[w] ^ a1[w] ^ a2[w]) & ~(a0[w] & a1[w] & a2[w]);
+        uint64_t trapped = ch & exactly_one;
+        while (trapped) {
+            int bit = highest_bit(trapped);
+            int u = w * 64 + bit;
+            if (!is_trapped_[u]) {
+                is_trapped_[u] = 1;
+                trapped_.push_back(u);
+            }
+            trapped &= ~(1ULL << bit);
+        }
+    }
+    return true;
+}
+
+// Copies colors, masks and counts into the graph's Vertex structs
+void DenseSolver::write_back() {
+    for (int v = 0; v < n_; ++v) {
+        Vertex& vert = graph_.vertex(v);
+        uint8_t allowed = 0;
+        for (int c = 0; c < 3; ++c) {
+            if ((allowed_[c][v >> 6] >> (v & 63)) & 1ULL) allowed |= static_cast<uint8_t>(1 << c);
+        }
+        vert.color = static_cast<Color>(color_[v]);
+        vert.forbidden_mask = static_cast<uint8_t>(~allowed & 0b111);
+        vert.colored_neighbors = colored_neighbors_[v];
+        vert.is_trapped = false;
+        vert.next_in_bucket = nullptr;
+        vert.prev_in_bucket = nullptr;
+    }
+}
+
+} // namespace threecolor
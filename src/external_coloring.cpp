@@ -0,0 +1,433 @@
+/*
+external_coloring.cpp
+
+Author: Dialo Sall
+
+Implementation of external_coloring.hpp
+*/
+#include "external_coloring.hpp"
+#include "buffered_writer.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <stdexcept>
+
+namespace threecolor {
+
+namespace {
+
+    const char kMagic[8] = {'3', 'C', 'A', 'D', 'J', '0', '0', '1'};
+    constexpr size_t kTrailerBytes = 32;
+    constexpr uint64_t kMinMergeBuffer = 64 << 10;
+
+    // Reads a file front to back in chunks of a fixed size; every byte that
+    // comes off the disk is added to *counter
+    class SequentialReader {
+    public:
+        SequentialReader(const std::string& path, size_t chunk, uint64_t* counter)
+            : file_(std::fopen(path.c_str(), "rb")), buffer_(std::max<size_t>(chunk, 64)),
+              pos_(0), len_(0), counter_(counter)
+        {
+            if (!file_) throw std::runtime_error("Could not open input file: " + path);
+            std::setvbuf(file_, nullptr, _IONBF, 0);
+        }
+
+        ~SequentialReader() { std::fclose(file_); }
+
+        SequentialReader(const SequentialReader&) = delete;
+        SequentialReader& operator=(const SequentialReader&) = delete;
+
+        // Next byte, or -1 at the end of the file
+        int get() {
+            if (pos_ == len_ && !fill()) return -1;
+            return static_cast<unsigned char>(buffer_[pos_++]);
+        }
+
+        bool read(void* out, size_t len) {
+            char* dst = static_cast<char*>(out);
+            while (len > 0) {
+                if (pos_ == len_ && !fill()) return false;
+                size_t take = std::min(len, len_ - pos_);
+                std::memcpy(dst, buffer_.data() + pos_, take);
+                pos_ += take;
+                dst += take;
+                len -= take;
+            }
+            return true;
+        }
+
+        // Decimal integer after any whitespace; false at the end of the file
+        bool next_int(int64_t& value) {
+            int c = get();
+            while (c == ' ' || c == '\n' || c == '\r' || c == '\t') c = get();
+            if (c < 0) return false;
+            bool negative = c == '-';
+            if (negative) c = get();
+            if (c < '0' || c > '9') throw std::runtime_error("Edge list: expected an integer");
+            value = 0;
+            while (c >= '0' && c <= '9') {
+                value = value * 10 + (c - '0');
+                c = get();
+            }
+            if (negative) value = -value;
+            return true;
+        }
+
+        // Moves len bytes forward; beyond the buffer this is a seek, so the
+        // skipped bytes are never read
+        void skip(uint64_t len) {
+            if (len <= len_ - pos_) {
+                pos_ += len;
+                return;
+            }
+            seek_from_current(static_cast<long>(len - (len_ - pos_)));
+        }
+
+        void seek(uint64_t offset) {
+            if (std::fseek(file_, static_cast<long>(offset), SEEK_SET) != 0) {
+                throw std::runtime_error("Could not seek in input file");
+            }
+            pos_ = len_ = 0;
+        }
+
+        uint64_t size() {
+            long here = std::ftell(file_);
+            std::fseek(file_, 0, SEEK_END);
+            long end = std::ftell(file_);
+            std::fseek(file_, here, SEEK_SET);
+            return static_cast<uint64_t>(end);
+        }
+
+    private:
+        std::FILE* file_;
+        std::vector<char> buffer_;
+        size_t pos_;
+        size_t len_;
+        uint64_t* counter_;
+
+        bool fill() {
+            len_ = std::fread(buffer_.data(), 1, buffer_.size(), file_);
+            pos_ = 0;
+            *counter_ += len_;
+            return len_ > 0;
+        }
+
+        void seek_from_current(long offset) {
+            if (std::fseek(file_, offset, SEEK_CUR) != 0) {
+                throw std::runtime_error("Could not seek in input file");
+            }
+            pos_ = len_ = 0;
+        }
+    };
+
+    int varint_size(uint32_t value) {
+        int size = 1;
+        while (value >= 0x80) {
+            value >>= 7;
+            ++size;
+        }
+        return size;
+    }
+
+    void write_varint(BufferedWriter& out, uint32_t value) {
+        while (value >= 0x80) {
+            out.put(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        out.put(static_cast<char>(value));
+    }
+
+    uint32_t read_varint(SequentialReader& in) {
+        uint32_t value = 0;
+        int shift = 0;
+        while (true) {
+            int byte = in.get();
+            if (byte < 0) throw std::runtime_error("Adjacency file ends inside a row");
+            value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            if (byte < 0x80) return value;
+            shift += 7;
+        }
+    }
+
+    // Decodes one row (first position, then ascending gaps) of the given size
+    void read_row(SequentialReader& in, uint32_t bytes, std::vector<int>& row) {
+        row.clear();
+        uint32_t used = 0;
+        uint32_t value = 0;
+        while (used < bytes) {
+            uint32_t delta = read_varint(in);
+            used += varint_size(delta);
+            value = row.empty() ? delta : value + delta;
+            row.push_back(static_cast<int>(value));
+        }
+    }
+
+    void write_u64(BufferedWriter& out, uint64_t value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    // Removes the sort runs however the build ends
+    struct RunFiles {
+        std::vector<std::string> paths;
+        ~RunFiles() {
+            for (const auto& path : paths) std::remove(path.c_str());
+        }
+    };
+
+    void read_edge_list_header(SequentialReader& in, const std::string& path, int64_t& n, int64_t& m) {
+        if (!in.next_int(n) || !in.next_int(m) || n < 0 || n > INT_MAX || m < 0) {
+            throw std::runtime_error("Bad edge list header: " + path);
+        }
+    }
+
+    // Next edge of the list, with its ids checked against n
+    void read_edge(SequentialReader& in, int64_t n, int64_t& u, int64_t& v) {
+        if (!in.next_int(u) || !in.next_int(v)) throw std::runtime_error("Edge list ends early");
+        if (u < 0 || v < 0 || u >= n || v >= n) {
+            throw std::out_of_range("Edge list: vertex id out of range");
+        }
+    }
+
+} // namespace
+
+ExternalBuildStats build_external_adjacency(const std::string& edge_list_path, const std::string& adjacency_path,
+                                            const ExternalOptions& options) {
+    ExternalBuildStats stats{0, 0, 0, 0, {0, 0}};
+    int64_t n = 0, m = 0;
+
+    // 1. degrees, then the processing order; repeated edges still count here,
+    //    the order only has to be fixed before the sort
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> rank_of;
+    {
+        SequentialReader in(edge_list_path, options.read_chunk, &stats.io.bytes_read);
+        read_edge_list_header(in, edge_list_path, n, m);
+        std::vector<uint32_t> degree(n, 0);
+        for (int64_t i = 0; i < m; ++i) {
+            int64_t u, v;
+            read_edge(in, n, u, v);
+            if (u == v) continue;
+            ++degree[u];
+            ++degree[v];
+        }
+        order.resize(n);
+        std::iota(order.begin(), order.end(), 0u);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](uint32_t a, uint32_t b) { return degree[a] > degree[b]; });
+        rank_of.resize(n);
+        for (int64_t i = 0; i < n; ++i) rank_of[order[i]] = static_cast<uint32_t>(i);
+    }
+
+    // 2. sorted runs of (source position, target position) keys
+    RunFiles runs;
+    {
+        const uint64_t capacity = std::max<uint64_t>(1024, options.memory_bytes / sizeof(uint64_t));
+        std::vector<uint64_t> keys;
+        keys.reserve(std::min<uint64_t>(capacity, 2 * static_cast<uint64_t>(m)));
+        auto flush_run = [&]() {
+            if (keys.empty()) return;
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            runs.paths.push_back(adjacency_path + ".run" + std::to_string(runs.paths.size()));
+            BufferedWriter out(runs.paths.back(), options.read_chunk);
+            out.write(reinterpret_cast<const char*>(keys.data()), keys.size() * sizeof(uint64_t));
+            out.close();
+            stats.io.bytes_written += out.bytes_written();
+            keys.clear();
+        };
+
+        SequentialReader in(edge_list_path, options.read_chunk, &stats.io.bytes_read);
+        read_edge_list_header(in, edge_list_path, n, m);
+        for (int64_t i = 0; i < m; ++i) {
+            int64_t u, v;
+            read_edge(in, n, u, v);
+            ++stats.input_edges;
+            if (u == v) {
+                ++stats.self_loops;
+                continue;
+            }
+            uint64_t ru = rank_of[u], rv = rank_of[v];
+            if (keys.size() + 2 > capacity) flush_run();
+            keys.push_back(ru << 32 | rv);
+            keys.push_back(rv << 32 | ru);
+        }
+        flush_run();
+    }
+    std::vector<uint32_t>().swap(rank_of);
+    stats.sort_runs = static_cast<int>(runs.paths.size());
+
+    // 3. merge the runs into rows, dropping the repeats that landed in different runs
+    std::vector<uint32_t> row_bytes(n, 0);
+    uint64_t kept = 0, rows_total = 0;
+    {
+        const size_t per_run = runs.paths.empty() ? kMinMergeBuffer
+            : static_cast<size_t>(std::max<uint64_t>(kMinMergeBuffer, options.memory_bytes / runs.paths.size()));
+        std::vector<std::unique_ptr<SequentialReader>> readers;
+        typedef std::pair<uint64_t, size_t> Head; // key, run
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        for (const auto& path : runs.paths) {
+            readers.emplace_back(new SequentialReader(path, std::min(per_run, options.read_chunk), &stats.io.bytes_read));
+            uint64_t key;
+            if (readers.back()->read(&key, sizeof(key))) heads.push(Head(key, readers.size() - 1));
+        }
+
+        BufferedWriter out(adjacency_path, options.read_chunk);
+        uint64_t last = UINT64_MAX;
+        while (!heads.empty()) {
+            Head head = heads.top();
+            heads.pop();
+            uint64_t key;
+            if (readers[head.second]->read(&key, sizeof(key))) heads.push(Head(key, head.second));
+            if (head.first == last) continue;
+
+            uint32_t source = static_cast<uint32_t>(head.first >> 32);
+            uint32_t target = static_cast<uint32_t>(head.first);
+            bool same_row = last != UINT64_MAX && static_cast<uint32_t>(last >> 32) == source;
+            uint32_t value = same_row ? target - static_cast<uint32_t>(last) : target;
+            write_varint(out, value);
+            row_bytes[source] += varint_size(value);
+            last = head.first;
+            ++kept;
+        }
+        rows_total = out.bytes_written();
+
+        out.write(reinterpret_cast<const char*>(row_bytes.data()), row_bytes.size() * sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(order.data()), order.size() * sizeof(uint32_t));
+        out.write(kMagic, sizeof(kMagic));
+        write_u64(out, static_cast<uint64_t>(n));
+        write_u64(out, kept / 2);
+        write_u64(out, rows_total);
+        out.close();
+        stats.io.bytes_written += out.bytes_written();
+    }
+
+    stats.duplicate_edges = stats.input_edges - stats.self_loops - kept / 2;
+    return stats;
+}
+
+ExternalColorer::ExternalColorer(const std::string& adjacency_path, const ExternalOptions& options)
+    : path_(adjacency_path), options_(options), stats_{0, 0, 0, {0, 0}}, n_(0), m_(0), row_bytes_total_(0)
+{
+    SequentialReader in(path_, options_.read_chunk, &stats_.io.bytes_read);
+    uint64_t size = in.size();
+    if (size < kTrailerBytes) throw std::runtime_error("Not an adjacency file: " + path_);
+
+    char magic[8];
+    uint64_t n = 0;
+    in.seek(size - kTrailerBytes);
+    bool ok = in.read(magic, sizeof(magic)) && in.read(&n, sizeof(n)) && in.read(&m_, sizeof(m_))
+              && in.read(&row_bytes_total_, sizeof(row_bytes_total_));
+    if (!ok || std::memcmp(magic, kMagic, sizeof(magic)) != 0 || n > INT_MAX
+        || row_bytes_total_ + 8 * n + kTrailerBytes != size) {
+        throw std::runtime_error("Not an adjacency file: " + path_);
+    }
+    n_ = static_cast<int>(n);
+
+    row_bytes_.resize(n_);
+    std::vector<uint32_t> order(n_);
+    in.seek(row_bytes_total_);
+    in.read(row_bytes_.data(), row_bytes_.size() * sizeof(uint32_t));
+    in.read(order.data(), order.size() * sizeof(uint32_t));
+    rank_of_.resize(n_);
+    for (int r = 0; r < n_; ++r) rank_of_[order[r]] = r;
+
+    color_.assign(n_, static_cast<int8_t>(UNCOLORED));
+    forbidden_mask_.assign(n_, 0);
+    conflicted_.assign(n_, 0);
+}
+
+bool ExternalColorer::run() {
+    std::mt19937 rng(options_.seed);
+    std::vector<int> row;
+
+    first_pass();
+    stats_.passes = 1;
+    uint64_t marked = stats_.first_pass_conflicts;
+    while (marked > 0 && stats_.passes <= options_.max_passes) {
+        marked = repair_pass(row, rng);
+        ++stats_.passes;
+    }
+    stats_.conflicted = marked;
+    return marked == 0;
+}
+
+void ExternalColorer::first_pass() {
+    SequentialReader in(path_, options_.read_chunk, &stats_.io.bytes_read);
+    std::vector<int> row;
+    for (int r = 0; r < n_; ++r) {
+        read_row(in, row_bytes_[r], row);
+        uint8_t mask = forbidden_mask_[r];
+        int c;
+        if (mask != 0x7) {
+            c = !(mask & 1) ? RED : !(mask & 2) ? BLUE : YELLOW;
+        } else {
+            // contradiction: take the least used color and leave it to the repair passes
+            int counts[3] = {0, 0, 0};
+            for (int w : row) {
+                if (color_[w] != UNCOLORED) ++counts[color_[w]];
+            }
+            c = static_cast<int>(std::min_element(counts, counts + 3) - counts);
+            conflicted_[r] = 1;
+            ++stats_.first_pass_conflicts;
+        }
+        color_[r] = static_cast<int8_t>(c);
+        for (int w : row) {
+            if (color_[w] == UNCOLORED) forbidden_mask_[w] = static_cast<uint8_t>(forbidden_mask_[w] | (1 << c));
+        }
+    }
+}
+
+uint64_t ExternalColorer::repair_pass(std::vector<int>& row, std::mt19937& rng) {
+    SequentialReader in(path_, options_.read_chunk, &stats_.io.bytes_read);
+    for (int r = 0; r < n_; ++r) {
+        if (!conflicted_[r]) {
+            in.skip(row_bytes_[r]);
+            continue;
+        }
+        read_row(in, row_bytes_[r], row);
+        int counts[3] = {0, 0, 0};
+        for (int w : row) ++counts[color_[w]];
+        if (counts[color_[r]] == 0) {
+            conflicted_[r] = 0;
+            continue;
+        }
+
+        // leave the current color for whichever of the other two fewer neighbors use
+        // (random among equals); moving even when it does not lower the count
+        // keeps two conflicted neighbors from both waiting on each other
+        int a = (color_[r] + 1) % 3, b = (color_[r] + 2) % 3;
+        int fewest = std::min(counts[a], counts[b]);
+        int c;
+        if (counts[a] != counts[b]) c = counts[a] < counts[b] ? a : b;
+        else c = std::uniform_int_distribution<int>(0, 1)(rng) ? a : b;
+        color_[r] = static_cast<int8_t>(c);
+        conflicted_[r] = fewest > 0;
+        for (int w : row) {
+            if (color_[w] == c) conflicted_[w] = 1;
+        }
+    }
+
+    uint64_t marked = 0;
+    for (uint8_t flag : conflicted_) marked += flag;
+    return marked;
+}
+
+bool ExternalColorer::verify() {
+    SequentialReader in(path_, options_.read_chunk, &stats_.io.bytes_read);
+    std::vector<int> row;
+    for (int r = 0; r < n_; ++r) {
+        if (color_[r] == UNCOLORED) return false;
+        read_row(in, row_bytes_[r], row);
+        for (int w : row) {
+            if (color_[w] == color_[r]) return false;
+        }
+    }
+    return true;
+}
+
+} // namespace threecolor
@@ -8,6 +8,7 @@ Implements functions defined in graph.hpp
 
 */
 #include "graph.hpp"
+#include "csr_graph.hpp"
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
@@ -57,6 +58,12 @@ namespace threecolor {
             vertices[i].prev_in_bucket = nullptr;
         }
 
+        if (other.compressed) {
+            adjacency = other.adjacency;
+            compressed = true;
+            return;
+        }
+
         //Rebuild adjacency lists
         for (int u = 0; u < other.num_vertices(); ++u) {
             for (Neighbor* p = other.vertices[u].neighbors_head; p != nullptr; p = p->next) {
@@ -84,9 +91,12 @@ namespace threecolor {
     }
 
     Graph::Graph(Graph&& other) noexcept
-        : vertices(std::move(other.vertices))
+        : vertices(std::move(other.vertices)),
+          adjacency(std::move(other.adjacency)),
+          compressed(other.compressed)
     {
         other.vertices.clear();
+        other.compressed = false;
     }
 
     Graph& Graph::operator=(Graph&& other) noexcept {
@@ -94,7 +104,10 @@ namespace threecolor {
 
         clear_neighbors();
         vertices = std::move(other.vertices);
+        adjacency = std::move(other.adjacency);
+        compressed = other.compressed;
         other.vertices.clear();
+        other.compressed = false;
 
         return *this;
     }
@@ -104,6 +117,9 @@ namespace threecolor {
             throw std::out_of_range("Cannot add edge: vertex id out of range");
         }
         if (u == v) return; // no self-loops
+        if (compressed) {
+            throw std::logic_error("Cannot add edge: graph is compressed");
+        }
 
         // u to v
         Neighbor* neighbor_u = new Neighbor{ &vertices[v], vertices[u].neighbors_head };
@@ -117,9 +133,7 @@ namespace threecolor {
     void Graph::compute_degrees() { // Computes degree of vertex, stores it in vertex member field
         for (auto& vertex : vertices) {
             int d = 0;
-            for (Neighbor* nbr = vertex.neighbors_head; nbr != nullptr; nbr = nbr->next) {
-                ++d;
-            }
+            for_each_neighbor(vertex.id, [&](int) { ++d; return true; });
             vertex.degree = d;
         }
     }
@@ -135,21 +149,53 @@ namespace threecolor {
         }
     }
 
+    void Graph::compress() {
+        if (compressed) return;
+        CsrGraph csr = CsrGraph::from_graph(*this);
+        adjacency = CompressedAdjacency(csr.offsets(), csr.targets());
+        clear_neighbors();
+        compressed = true;
+        for (auto& vertex : vertices) vertex.degree = csr.degree(vertex.id);
+    }
+
+    uint64_t Graph::adjacency_bytes() const {
+        if (compressed) return adjacency.bytes();
+        uint64_t nodes = 0;
+        for (const auto& vertex : vertices) {
+            for (Neighbor* p = vertex.neighbors_head; p != nullptr; p = p->next) ++nodes;
+        }
+        return nodes * sizeof(Neighbor);
+    }
+
     // Simple text format: first line: n m (num vertices, num edges)
-    Graph Graph::from_edge_list_file(const std::string& path) {
+    Graph Graph::from_edge_list_file(const std::string& path, bool compressed) {
         std::ifstream in(path);
         if (!in) {
             throw std::runtime_error("Could not open graph file: " + path);
         }
+        return from_edge_list(in, compressed);
+    }
+
+    Graph Graph::from_edge_list(std::istream& in, bool compressed) {
         int n, m;
-        in >> n >> m;
-        Graph g(n);
+        if (!(in >> n >> m) || n < 0 || m < 0) {
+            throw std::runtime_error("Bad edge list header");
+        }
+        std::vector<Edge> edges(m);
         for (int i = 0; i < m; ++i) {
-            int u, v;
-            in >> u >> v;
-            g.add_edge(u, v);
+            if (!(in >> edges[i].u >> edges[i].v)) {
+                throw std::runtime_error("Edge list ends early");
+            }
         }
-        g.compute_degrees();
+        // the bulk builder drops repeated edges and self-loops, so degrees stay exact
+        CsrGraph csr = CsrGraph::from_edges(n, edges);
+        if (!compressed) return csr.to_graph();
+
+        std::vector<Edge>().swap(edges);
+        Graph g(n);
+        g.adjacency = CompressedAdjacency(csr.offsets(), csr.targets());
+        g.compressed = true;
+        for (auto& vertex : g.vertices) vertex.degree = csr.degree(vertex.id);
         return g;
     }
 
@@ -0,0 +1,222 @@
+/*
+load_client.cpp
+
+Author: Dialo Sall
+
+Load generator for color3 --serve
+    load_client socket [--requests N] [--connections C] [--vertices n] [--degree d]
+                       [--solver greedy|cdcl|auto] [--deadline ms] [--format binary|text]
+                       [--random] [--subprocess path/to/color3] [--shutdown]
+Each connection sends its share of the requests one after another (the next
+as soon as the previous answer arrives), cycling through 16 planted graphs,
+or plain random graphs with --random (mostly not 3-colorable above degree
+4.7, so CDCL runs into the deadline). Every coloring that comes back is checked against its graph.
+Prints requests/sec, latency percentiles and a count per status.
+--subprocess also times the old way for comparison: write each graph to a
+file and run color3 on it once per request
+--shutdown asks the service to exit when the run is done
+*/
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+#include "graph.hpp"
+#include "solve_service.hpp"
+#include "utilities.hpp"
+
+using namespace threecolor;
+
+struct TestGraph {
+    int n;
+    std::vector<std::pair<int, int>> edges;
+    std::string payload;
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+static bool coloring_is_valid(const TestGraph& graph, const std::string& colors) {
+    if (static_cast<int>(colors.size()) != graph.n) return false;
+    for (const auto& e : graph.edges) {
+        if (colors[e.first] == colors[e.second]) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: load_client socket [--requests N] [--connections C] [--vertices n] [--degree d]\n"
+                  << "                          [--solver greedy|cdcl|auto] [--deadline ms] [--format binary|text]\n"
+                  << "                          [--random] [--subprocess path/to/color3] [--shutdown]\n";
+        return 1;
+    }
+
+    try {
+        std::signal(SIGPIPE, SIG_IGN);
+        std::string socket_path = argv[1];
+        int requests = 1000, connections = 4, vertices = 1000;
+        double degree = 3.0;
+        ServiceSolver solver = ServiceSolver::AUTO;
+        uint32_t deadline_ms = 0;
+        PayloadFormat format = PayloadFormat::BINARY;
+        std::string subprocess;
+        bool shutdown_after = false;
+        bool random = false;
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--requests" && has_value)         requests = std::stoi(argv[++i]);
+            else if (arg == "--connections" && has_value) connections = std::max(1, std::stoi(argv[++i]));
+            else if (arg == "--vertices" && has_value)    vertices = std::stoi(argv[++i]);
+            else if (arg == "--degree" && has_value)      degree = std::stod(argv[++i]);
+            else if (arg == "--solver" && has_value)      solver = parse_service_solver(argv[++i]);
+            else if (arg == "--deadline" && has_value)    deadline_ms = static_cast<uint32_t>(std::stoul(argv[++i]));
+            else if (arg == "--format" && has_value) {
+                std::string name = argv[++i];
+                if (name == "binary")    format = PayloadFormat::BINARY;
+                else if (name == "text") format = PayloadFormat::EDGE_LIST;
+                else throw std::invalid_argument("Unknown format: " + name);
+            }
+            else if (arg == "--subprocess" && has_value)  subprocess = argv[++i];
+            else if (arg == "--random")                   random = true;
+            else if (arg == "--shutdown")                 shutdown_after = true;
+            else throw std::invalid_argument("Unknown argument: " + arg);
+        }
+
+        auto rng = make_rng();
+        std::vector<TestGraph> graphs(16);
+        for (auto& graph : graphs) {
+            Graph g = random ? generate_sparse_random_graph(vertices, degree / vertices, rng)
+                             : generate_sparse_planted_graph(vertices, degree / vertices, rng);
+            graph.n = vertices;
+            for (int u = 0; u < vertices; ++u) {
+                g.for_each_neighbor(u, [&](int w) {
+                    if (w > u) graph.edges.push_back(std::make_pair(u, w));
+                    return true;
+                });
+            }
+            if (format == PayloadFormat::BINARY) {
+                graph.payload = encode_binary_graph(graph.n, graph.edges);
+            } else {
+                graph.payload = std::to_string(graph.n) + " " + std::to_string(graph.edges.size()) + "\n";
+                for (const auto& e : graph.edges) {
+                    graph.payload += std::to_string(e.first) + " " + std::to_string(e.second) + "\n";
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::vector<double> latencies_ms;
+        std::map<std::string, int> statuses;
+        int invalid = 0;
+        uint64_t solve_us = 0;
+        std::string error; // first failure seen by a connection thread
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int c = 0; c < connections; ++c) {
+            threads.emplace_back([&, c] {
+                try {
+                    int fd = connect_unix_socket(socket_path);
+                    std::vector<double> local;
+                    for (int i = c; i < requests; i += connections) {
+                        SolveRequest request;
+                        request.id = static_cast<uint64_t>(i);
+                        request.solver = solver;
+                        request.format = format;
+                        request.deadline_ms = deadline_ms;
+                        request.payload = graphs[i % graphs.size()].payload;
+
+                        auto sent = std::chrono::steady_clock::now();
+                        std::string body;
+                        SolveResponse response;
+                        if (!write_frame(fd, encode_request(request)) || !read_frame(fd, body)
+                            || !decode_response(body, response)) {
+                            throw std::runtime_error("connection to the service lost");
+                        }
+                        local.push_back(std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - sent).count());
+
+                        std::lock_guard<std::mutex> lock(mutex);
+                        ++statuses[response_status_name(response.status)];
+                        solve_us += response.solve_us;
+                        if (response.status == ResponseStatus::COLORED
+                            && !coloring_is_valid(graphs[i % graphs.size()], response.data)) {
+                            ++invalid;
+                        }
+                    }
+                    ::close(fd);
+                    std::lock_guard<std::mutex> lock(mutex);
+                    latencies_ms.insert(latencies_ms.end(), local.begin(), local.end());
+                } catch (const std::exception& ex) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (error.empty()) error = ex.what();
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        if (!error.empty()) throw std::runtime_error(error);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::sort(latencies_ms.begin(), latencies_ms.end());
+        std::cout << "Requests:     " << requests << " over " << connections << " connections, n=" << vertices
+                  << ", degree=" << degree << "\n";
+        std::cout << "Throughput:   " << requests / seconds << " requests/s\n";
+        std::cout << "Latency (ms): p50 " << percentile(latencies_ms, 0.50) << ", p90 " << percentile(latencies_ms, 0.90)
+                  << ", p99 " << percentile(latencies_ms, 0.99) << ", max "
+                  << (latencies_ms.empty() ? 0.0 : latencies_ms.back()) << "\n";
+        std::cout << "Solve (ms):   " << solve_us / 1000.0 / std::max(1, requests) << " mean inside the service\n";
+        std::cout << "Statuses:    ";
+        for (const auto& entry : statuses) std::cout << " " << entry.first << "=" << entry.second;
+        std::cout << "\n";
+        if (invalid > 0) std::cout << "INVALID colorings: " << invalid << "\n";
+
+        if (!subprocess.empty()) {
+            // the same graphs through one process per request
+            const std::string path = "load_client_graph.txt";
+            const int runs = std::min(requests, 200);
+            auto sub_start = std::chrono::steady_clock::now();
+            for (int i = 0; i < runs; ++i) {
+                const TestGraph& graph = graphs[i % graphs.size()];
+                {
+                    FILE* out = std::fopen(path.c_str(), "w");
+                    if (!out) throw std::runtime_error("Could not write " + path);
+                    std::fprintf(out, "%d %zu\n", graph.n, graph.edges.size());
+                    for (const auto& e : graph.edges) std::fprintf(out, "%d %d\n", e.first, e.second);
+                    std::fclose(out);
+                }
+                std::string command = subprocess + " " + path + " > /dev/null 2>&1";
+                if (std::system(command.c_str()) != 0) throw std::runtime_error("subprocess failed: " + command);
+            }
+            double sub_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sub_start).count();
+            std::remove(path.c_str());
+            std::cout << "Subprocess:   " << runs / sub_seconds << " requests/s (" << runs
+                      << " sequential runs of " << subprocess << ", DOT export included)\n";
+        }
+
+        if (shutdown_after) {
+            int fd = connect_unix_socket(socket_path);
+            SolveRequest request;
+            request.type = RequestType::SHUTDOWN;
+            write_frame(fd, encode_request(request));
+            ::close(fd);
+        }
+        return invalid > 0 ? 1 : 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+}
@@ -6,49 +6,283 @@ Author: Dialo Sall
 If a file path is provided, main.cpp loads a graph from the file.
 Otherwise, a random graph is generated
 
-ThreeColorSolver is executed on the graph, and a success/failure is printed
+The greedy solver is executed on the graph, and a success/failure is printed
 Verifies coloring after success
+
+Usage: color3 [graph.txt] [--trace trace.bin] [--export dot|text|binary|dimacs|edges|none] [--filter]
+                                 [--engine auto|sparse|dense] [--policy list] [--solver greedy|parallel|cdcl|dsatur|rlf]
+                                 [--compress] [--external] [--memory MB]
+                                 [--checkpoint file] [--checkpoint-interval s] [--checkpoint-budget pct]
+       color3 --serve socket|- [--workers N]
+    --trace writes a binary step trace (see trace_tool)
+    --export picks the output format (default dot); "none" skips exporting
+    --filter looks for a K4 or odd wheel before the solver runs; one found
+             proves the graph is not 3-colorable and the solver is skipped
+    --engine picks the greedy implementation (default auto: dense graphs use bitsets)
+    --policy changes the greedy rules, e.g. least-used,higher-id,no-trapped (see parse_policy)
+    --solver parallel colors in rounds on every core (Jones-Plassmann style)
+    --solver cdcl runs the exact clause-learning search instead of the greedy
+    --solver dsatur|rlf runs a baseline heuristic instead (see baseline_solvers.hpp)
+    --compress keeps the adjacency as delta + varint rows (see compressed_adjacency.hpp)
+    --external colors graph.txt without loading it: the edges are sorted into graph.txt.adj
+               on disk and streamed, using about --memory MB (default 256) for the sort
+    --checkpoint snapshots a --solver cdcl search to file every --checkpoint-interval
+                 seconds (default 30), keeping the cost under --checkpoint-budget percent
+                 of the run (default 1); Ctrl-C stops with a final snapshot, and running
+                 the same command again resumes from it (see checkpoint.hpp)
+    --serve runs as a solver service on a Unix-domain socket, or on stdin/stdout
+            for "-", until a shutdown request (see solve_service.hpp, load_client)
 */
 
+#include <atomic>
+#include <csignal>
+#include <cstdio>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include "graph.hpp"
 #include "algorithm.hpp"
+#include "baseline_solvers.hpp"
+#include "cdcl_solver.hpp"
+#include "checkpoint.hpp"
+#include "external_coloring.hpp"
+#include "parallel_greedy.hpp"
+#include "solve_service.hpp"
+#include "unsat_filter.hpp"
 #include "utilities.hpp"
+#include "verify.hpp"
 
 using namespace threecolor;
 
+// Set by SIGINT / SIGTERM while a checkpointed search runs
+static std::atomic<bool> interrupted(false);
+
+static void on_interrupt(int) {
+    interrupted.store(true);
+}
+
+// Name of a --solver choice in the result line
+static const char* solver_label(const std::string& solver) {
+    if (solver == "cdcl")     return "CDCL";
+    if (solver == "parallel") return "Parallel greedy";
+    if (solver == "dsatur")   return "DSATUR";
+    if (solver == "rlf")      return "RLF";
+    return "Greedy";
+}
+
 int main(int argc, char** argv) {
     try {
+        std::string input_path;
+        std::string trace_path;
+        ExportFormat export_format = ExportFormat::DOT;
+        bool use_filter = false;
+        Engine engine = Engine::AUTO;
+        PolicyConfig policy;
+        std::string solver = "greedy";
+        bool compress = false;
+        bool external = false;
+        ExternalOptions external_options;
+        std::string serve_path;
+        ServiceOptions service_options;
+        std::string checkpoint_path;
+        CheckpointOptions checkpoint_options;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--trace" && i + 1 < argc) {
+                trace_path = argv[++i];
+            } else if (arg == "--filter") {
+                use_filter = true;
+            } else if (arg == "--engine" && i + 1 < argc) {
+                engine = parse_engine(argv[++i]);
+            } else if (arg == "--policy" && i + 1 < argc) {
+                policy = parse_policy(argv[++i]);
+            } else if (arg == "--solver" && i + 1 < argc) {
+                solver = argv[++i];
+                if (solver != "greedy" && solver != "parallel" && solver != "cdcl"
+                    && solver != "dsatur" && solver != "rlf") {
+                    throw std::invalid_argument("Unknown solver: " + solver);
+                }
+            } else if (arg == "--compress") {
+                compress = true;
+            } else if (arg == "--external") {
+                external = true;
+            } else if (arg == "--memory" && i + 1 < argc) {
+                external_options.memory_bytes = std::stoull(argv[++i]) << 20;
+            } else if (arg == "--serve" && i + 1 < argc) {
+                serve_path = argv[++i];
+            } else if (arg == "--workers" && i + 1 < argc) {
+                service_options.workers = std::stoi(argv[++i]);
+            } else if (arg == "--checkpoint" && i + 1 < argc) {
+                checkpoint_path = argv[++i];
+            } else if (arg == "--checkpoint-interval" && i + 1 < argc) {
+                checkpoint_options.interval_seconds = std::stod(argv[++i]);
+            } else if (arg == "--checkpoint-budget" && i + 1 < argc) {
+                checkpoint_options.max_overhead_percent = std::stod(argv[++i]);
+            } else if (arg == "--export" && i + 1 < argc) {
+                export_format = parse_export_format(argv[++i]);
+            } else {
+                input_path = arg;
+            }
+        }
+
+        if (!checkpoint_path.empty() && (solver != "cdcl" || input_path.empty())) {
+            throw std::invalid_argument("--checkpoint needs --solver cdcl and a graph file");
+        }
+
+        if (!serve_path.empty()) {
+            // a client that disconnects early must not kill the service
+            std::signal(SIGPIPE, SIG_IGN);
+            SolveService service(service_options);
+            if (serve_path == "-") serve_stream(service, 0, 1);
+            else serve_unix_socket(service, serve_path);
+            return 0;
+        }
+
+        if (external) {
+            // the graph is never loaded: only per-vertex state is kept in memory
+            if (input_path.empty()) throw std::invalid_argument("--external needs an edge list file");
+            std::string adjacency_path = input_path + ".adj";
+            ExternalBuildStats build = build_external_adjacency(input_path, adjacency_path, external_options);
+            ExternalColorer colorer(adjacency_path, external_options);
+            bool ok = colorer.run();
+            const ExternalColorStats& st = colorer.stats();
+            std::cout << "External 3-color result: " << (ok ? "Success" : "Failure") << " after "
+                      << st.passes << " passes (" << st.first_pass_conflicts << " conflicted after the first, "
+                      << st.conflicted << " left)\n";
+            std::cout << "  sort: " << build.sort_runs << " runs, read " << build.io.bytes_read << " bytes, wrote "
+                      << build.io.bytes_written << " bytes; passes read " << st.io.bytes_read << " bytes\n";
+            if (ok) std::cout << (colorer.verify() ? "Coloring verified.\n" : "Coloring appears invalid.\n");
+            std::remove(adjacency_path.c_str());
+            return 0;
+        }
+
         Graph g;
 
-        if (argc > 1) {
+        if (!input_path.empty()) {
             // Load from file if path provided
-            g = Graph::from_edge_list_file(argv[1]);
+            g = Graph::from_edge_list_file(input_path, compress);
         } else {
             // Otherwise generate a small random graph
             auto rng = make_rng();
             g = generate_random_graph(10, 0.3, rng);
             g.compute_degrees();
+            if (compress) g.compress();
+        }
+
+        // With --filter, a K4 or odd wheel proves failure before any solver runs;
+        // the result line names the solver that was asked for, and the export
+        // still happens
+        bool proven_unsat = false;
+        if (use_filter) {
+            UnsatWitness witness = find_unsat_witness(g);
+            if (witness.found()) {
+                proven_unsat = true;
+                std::cout << solver_label(solver) << " 3-color result: "
+                          << (solver == "cdcl" ? solve_status_name(SolveStatus::UNSATISFIABLE) : "Failure") << "\n";
+                std::cout << "Not 3-colorable: found " << witness_kind_name(witness.kind) << " on vertices";
+                for (int v : witness.vertices) std::cout << " " << v;
+                std::cout << "\n";
+                if (!trace_path.empty()) {
+                    std::cout << "No trace written to " << trace_path << ": the filter settled the run before the solver started\n";
+                }
+            }
         }
 
-        ThreeColorSolver solver(g);
-        bool ok = solver.run_greedy();
+        bool ok = false;
+        if (proven_unsat) {
+            // nothing left to run
+        } else if (solver == "cdcl") {
+            CdclOptions cdcl_options;
+            std::unique_ptr<CheckpointWriter> checkpoint;
+            if (!checkpoint_path.empty()) {
+                checkpoint.reset(new CheckpointWriter(checkpoint_path, checkpoint_options));
+                cdcl_options.checkpoint = checkpoint.get();
+                cdcl_options.stop = &interrupted;
+                std::signal(SIGINT, on_interrupt);
+                std::signal(SIGTERM, on_interrupt);
+            }
+
+            CdclSolver cdcl(g, cdcl_options);
+            std::string snapshot;
+            if (checkpoint && load_checkpoint(checkpoint_path, CheckpointKind::CDCL, snapshot)) {
+                cdcl.resume(snapshot);
+                std::cout << "Resumed from " << checkpoint_path << " after " << cdcl.stats().conflicts
+                          << " conflicts\n";
+            }
+            SolveStatus status = cdcl.solve();
+            ok = status == SolveStatus::SATISFIABLE;
+            const CdclStats& st = cdcl.stats();
+            std::cout << solver_label(solver) << " 3-color result: " << solve_status_name(status) << "\n";
+            std::cout << "  decisions " << st.decisions << ", conflicts " << st.conflicts
+                      << ", restarts " << st.restarts << ", learned " << st.learned << "\n";
 
-        std::cout << "Greedy 3-color result: " << (ok ? "Success" : "Failure") << "\n";
+            if (checkpoint) {
+                // a finished search needs no snapshot; a stopped one keeps its last
+                if (status == SolveStatus::UNKNOWN) checkpoint->close();
+                else checkpoint->discard();
+                CheckpointStats cs = checkpoint->stats();
+                std::cout << "  checkpoints: " << cs.snapshots << " written (last " << cs.last_bytes
+                          << " bytes), cost " << cs.overhead_percent << "% of " << cs.run_seconds << " s\n";
+                if (cs.failures > 0) std::cout << "  " << cs.failures << " checkpoint writes failed\n";
+                if (status == SolveStatus::UNKNOWN) {
+                    std::cout << "  stopped; run the same command again to resume from " << checkpoint_path << "\n";
+                }
+            }
+        } else if (solver == "parallel") {
+            ParallelGreedySolver parallel(g);
+            ok = parallel.run_greedy();
+            std::cout << solver_label(solver) << " 3-color result: " << (ok ? "Success" : "Failure")
+                      << " after " << parallel.stats().rounds << " rounds\n";
+        } else if (solver == "dsatur" || solver == "rlf") {
+            BaselineStats st;
+            if (solver == "dsatur") {
+                DsaturSolver dsatur(g);
+                ok = dsatur.run_greedy();
+                st = dsatur.stats();
+            } else {
+                RlfSolver rlf(g);
+                ok = rlf.run_greedy();
+                st = rlf.stats();
+            }
+            std::cout << solver_label(solver) << " 3-color result: " << (ok ? "Success" : "Failure");
+            if (!ok) std::cout << " (vertex " << st.contradiction << " has every color forbidden, "
+                               << st.uncolored << " uncolored)";
+            std::cout << "\n";
+        } else {
+            std::unique_ptr<TraceRecorder> tracer;
+            if (!trace_path.empty()) {
+                tracer.reset(new TraceRecorder(trace_path, g.num_vertices()));
+            }
 
-        if (ok && solver.verify_coloring()) {
-            std::cout << "Coloring verified.\n";
-        } else if (ok) {
-            std::cout << "Coloring appears invalid.\n";
+            ok = run_greedy_with_policy(g, policy, engine, tracer.get());
+
+            if (tracer) {
+                tracer->close();
+                std::cout << "Trace of " << tracer->total_records() << " steps written to " << trace_path << "\n";
+            }
+
+            std::cout << solver_label(solver) << " 3-color result: " << (ok ? "Success" : "Failure") << "\n";
         }
 
-        // Optional: export to DOT
         if (ok) {
-            export_to_dot(g, "colored_success.dot");
-            std::cout << "Graph exported to colored_success.dot\n";
-        } else {
-            export_to_dot(g, "colored_failure.dot");
-            std::cout << "Graph exported to colored_failure.dot\n";
+            VerifyReport report = verify_coloring_parallel(g);
+            if (report.valid) {
+                std::cout << "Coloring verified.\n";
+            } else if (report.bad_u >= 0) {
+                std::cout << "Coloring appears invalid: edge " << report.bad_u << "-" << report.bad_v
+                          << " has both endpoints the same color.\n";
+            } else {
+                std::cout << "Coloring appears invalid: vertex " << report.bad_vertex << " is uncolored.\n";
+            }
+        }
+
+        // Optional: export the result
+        if (export_format != ExportFormat::NONE) {
+            std::string out_path = std::string(ok ? "colored_success" : "colored_failure")
+                                   + export_extension(export_format);
+            export_graph(g, out_path, export_format);
+            std::cout << "Graph exported to " << out_path << "\n";
         }
 
         return 0;
@@ -0,0 +1,257 @@
+/*
+parallel_greedy.cpp
+
+Author: Dialo Sall
+
+Implementation of parallel_greedy.hpp
+
+Which phase touches what:
+    color   reads masks and committed flags, writes its own color and picked flag,
+            and the ranking of any neighbor it looks at (see rank_neighborhood)
+    detect  reads picked flags and colors, writes its own lost flag
+    commit  writes its own color and flags, fetch_or / fetch_add on neighbor
+            masks and colored-neighbor counts
+Each phase ends when every thread has joined, so no phase reads a value
+another thread is writing; only the neighbor masks and counts need atomics
+*/
+#include "parallel_greedy.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <climits>
+
+namespace threecolor {
+
+namespace {
+
+    constexpr int64_t kChunk = 2048;
+    constexpr int kDirectScan = 32; // longer neighbor lists are ranked once per round
+
+    // Priority layout: trapped bit 63 | degree bits 41-62 | colored neighbors bits 19-40 | random bits 0-18
+    constexpr int64_t kMaxKey = (1 << 22) - 1;
+    constexpr uint64_t kRandomMask = (1ULL << 19) - 1;
+
+    uint64_t splitmix64(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    // RED, then BLUE, then YELLOW
+    inline int8_t first_free_color(uint8_t mask) {
+        if ((mask & 1) == 0) return RED;
+        if ((mask & 2) == 0) return BLUE;
+        return YELLOW;
+    }
+
+    // Lower a shared minimum without a lock
+    inline void atomic_min(std::atomic<int>& target, int value) {
+        int current = target.load(std::memory_order_relaxed);
+        while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+    }
+
+} // namespace
+
+ParallelGreedySolver::ParallelGreedySolver(Graph& g, const ParallelGreedyOptions& options)
+    : graph_(g),
+      options_(options),
+      stats_{0, 0, 0, -1},
+      n_(g.num_vertices()),
+      threads_(options.threads > 0 ? options.threads : default_thread_count()),
+      adj_(CsrGraph::from_graph(g, threads_)),
+      forbidden_mask_(new std::atomic<uint8_t>[g.num_vertices()]),
+      colored_neighbors_(new std::atomic<int>[g.num_vertices()]),
+      ranked_round_(new std::atomic<uint32_t>[g.num_vertices()]),
+      best_(new std::atomic<int>[g.num_vertices()]),
+      second_(new std::atomic<int>[g.num_vertices()]),
+      round_(0)
+{
+    base_priority_.resize(n_);
+    parallel_for_chunks(0, n_, kChunk, threads_, [&](int64_t b, int64_t e, int) {
+        for (int64_t v = b; v < e; ++v) {
+            uint64_t random = splitmix64(options_.seed ^ static_cast<uint64_t>(v)) & kRandomMask;
+            uint64_t degree = static_cast<uint64_t>(std::min<int64_t>(adj_.degree(static_cast<int>(v)), kMaxKey));
+            base_priority_[v] = options_.priority == ParallelPriority::DEGREE ? (degree << 41) | random : random;
+        }
+    });
+
+    color_.resize(n_);
+    committed_.resize(n_);
+    picked_.resize(n_);
+    lost_.resize(n_);
+    next_.resize(threads_);
+}
+
+uint64_t ParallelGreedySolver::priority(int v) const {
+    uint8_t mask = forbidden_mask_[v].load(std::memory_order_relaxed);
+    bool trapped = mask == 0b011 || mask == 0b101 || mask == 0b110;
+    uint64_t colored = static_cast<uint64_t>(std::min<int64_t>(colored_neighbors_[v].load(std::memory_order_relaxed), kMaxKey));
+    return (trapped ? (1ULL << 63) : 0) | base_priority_[v] | (colored << 19);
+}
+
+bool ParallelGreedySolver::beats(int a, int b) const {
+    uint64_t pa = priority(a), pb = priority(b);
+    return pa != pb ? pa > pb : a < b;
+}
+
+// The two highest priority vertices among w and its uncolored neighbors, computed
+// at most once per round in the usual case: priorities and committed flags do not
+// change during the color phase, so two threads that race on w store the same pair
+// before publishing the round stamp
+void ParallelGreedySolver::rank_neighborhood(int w, int& best_out, int& second_out) {
+    int best = w, second = -1;
+    for (const int* p = adj_.begin(w); p != adj_.end(w); ++p) {
+        int u = *p;
+        if (committed_[u]) continue;
+        if (beats(u, best)) {
+            second = best;
+            best = u;
+        } else if (second == -1 || beats(u, second)) {
+            second = u;
+        }
+    }
+    best_[w].store(best, std::memory_order_relaxed);
+    second_[w].store(second, std::memory_order_relaxed);
+    ranked_round_[w].store(round_, std::memory_order_release);
+    best_out = best;
+    second_out = second;
+}
+
+// v beats every uncolored vertex within distance two reached through uncolored
+// vertices, so no uncolored vertex sees two of its neighbors colored in one round
+// Direct neighbors first, since most vertices lose there. A short list is then
+// walked directly; a longer one is ranked once per round and shared by every
+// vertex that asks, so a hub costs O(degree) per round rather than per neighbor
+bool ParallelGreedySolver::is_local_max(int v) {
+    for (const int* p = adj_.begin(v); p != adj_.end(v); ++p) {
+        if (!committed_[*p] && beats(*p, v)) return false;
+    }
+    for (const int* p = adj_.begin(v); p != adj_.end(v); ++p) {
+        int w = *p;
+        if (committed_[w]) continue;
+        int best, second;
+        if (ranked_round_[w].load(std::memory_order_acquire) == round_) {
+            best = best_[w].load(std::memory_order_relaxed);
+            second = second_[w].load(std::memory_order_relaxed);
+        } else if (adj_.degree(w) <= kDirectScan) {
+            for (const int* q = adj_.begin(w); q != adj_.end(w); ++q) {
+                if (*q != v && !committed_[*q] && beats(*q, v)) return false;
+            }
+            continue;
+        } else {
+            rank_neighborhood(w, best, second);
+        }
+        // v is in w's neighborhood, so the best other than v is one of the two
+        int rival = best != v ? best : second;
+        if (rival != -1 && beats(rival, v)) return false;
+    }
+    return true;
+}
+
+bool ParallelGreedySolver::run_greedy() {
+    stats_ = ParallelGreedyStats{0, 0, 0, -1};
+    for (int v = 0; v < n_; ++v) {
+        forbidden_mask_[v].store(0, std::memory_order_relaxed);
+        colored_neighbors_[v].store(0, std::memory_order_relaxed);
+        ranked_round_[v].store(0, std::memory_order_relaxed);
+    }
+    std::fill(color_.begin(), color_.end(), static_cast<int8_t>(UNCOLORED));
+    std::fill(committed_.begin(), committed_.end(), 0);
+    std::fill(picked_.begin(), picked_.end(), 0);
+    std::fill(lost_.begin(), lost_.end(), 0);
+
+    work_.resize(n_);
+    for (int v = 0; v < n_; ++v) work_[v] = v;
+
+    std::atomic<int> contradiction(INT_MAX);
+    std::atomic<uint64_t> conflicts(0);
+
+    while (!work_.empty()) {
+        ++stats_.rounds;
+        int64_t size = static_cast<int64_t>(work_.size());
+
+        round_ = static_cast<uint32_t>(stats_.rounds);
+
+        // 1. color the local maxima (or everyone, when speculating)
+        parallel_for_chunks(0, size, kChunk, threads_, [&](int64_t b, int64_t e, int) {
+            for (int64_t i = b; i < e; ++i) {
+                int v = work_[i];
+                lost_[v] = 0;
+                uint8_t mask = forbidden_mask_[v].load(std::memory_order_relaxed);
+                if (mask == 0b111) {
+                    atomic_min(contradiction, v);
+                    continue;
+                }
+
+                if (options_.speculative || is_local_max(v)) {
+                    color_[v] = first_free_color(mask);
+                    picked_[v] = 1;
+                }
+            }
+        });
+        if (contradiction.load() != INT_MAX) break;
+
+        // 2. same color on both ends of an edge: the higher priority end keeps it
+        if (options_.speculative) {
+            parallel_for_chunks(0, size, kChunk, threads_, [&](int64_t b, int64_t e, int) {
+                for (int64_t i = b; i < e; ++i) {
+                    int v = work_[i];
+                    if (!picked_[v]) continue;
+                    for (const int* p = adj_.begin(v); p != adj_.end(v); ++p) {
+                        int w = *p;
+                        if (picked_[w] && color_[w] == color_[v] && beats(w, v)) {
+                            lost_[v] = 1;
+                            break;
+                        }
+                    }
+                }
+            });
+        }
+
+        // 3. commit the survivors and collect the next round's work
+        for (auto& part : next_) part.clear();
+        parallel_for_chunks(0, size, kChunk, threads_, [&](int64_t b, int64_t e, int t) {
+            uint64_t undone = 0;
+            for (int64_t i = b; i < e; ++i) {
+                int v = work_[i];
+                if (picked_[v] && !lost_[v]) {
+                    committed_[v] = 1;
+                    uint8_t bit = static_cast<uint8_t>(1 << color_[v]);
+                    for (const int* p = adj_.begin(v); p != adj_.end(v); ++p) {
+                        forbidden_mask_[*p].fetch_or(bit, std::memory_order_relaxed);
+                        colored_neighbors_[*p].fetch_add(1, std::memory_order_relaxed);
+                    }
+                } else {
+                    if (picked_[v]) {
+                        color_[v] = UNCOLORED;
+                        ++undone;
+                    }
+                    next_[t].push_back(v);
+                }
+                picked_[v] = 0;
+            }
+            if (undone) conflicts.fetch_add(undone, std::memory_order_relaxed);
+        });
+
+        work_.clear();
+        for (auto& part : next_) work_.insert(work_.end(), part.begin(), part.end());
+    }
+
+    stats_.conflicts = conflicts.load();
+    stats_.colored = static_cast<uint64_t>(n_) - work_.size();
+    if (contradiction.load() != INT_MAX) stats_.contradiction = contradiction.load();
+
+    write_back();
+    return work_.empty();
+}
+
+void ParallelGreedySolver::write_back() {
+    graph_.reset_coloring_state();
+    for (int v = 0; v < n_; ++v) {
+        Vertex& vert = graph_.vertex(v);
+        vert.color = committed_[v] ? static_cast<Color>(color_[v]) : UNCOLORED;
+        vert.forbidden_mask = forbidden_mask_[v].load(std::memory_order_relaxed);
+    }
+}
+
+} // namespace threecolor
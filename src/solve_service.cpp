@@ -0,0 +1,500 @@
+/*
+solve_service.cpp
+
+Author: Dialo Sall
+
+Implementation of solve_service.hpp
+*/
+#include "solve_service.hpp"
+#include "algorithm.hpp"
+#include "cdcl_solver.hpp"
+#include "csr_graph.hpp"
+#include "parallel.hpp"
+#include "unsat_filter.hpp"
+#include "verify.hpp"
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace threecolor {
+
+namespace {
+
+    constexpr uint32_t kMaxFrame = 1u << 30;
+    constexpr size_t kRequestHeader = 16;  // id, type, solver, format, reserved, deadline
+    constexpr size_t kResponseHeader = 20; // id, status, reserved, solve_us, size
+
+    void put_u32(std::string& out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    void put_u64(std::string& out, uint64_t value) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    uint32_t get_u32(const char* p) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= static_cast<uint32_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        return value;
+    }
+
+    uint64_t get_u64(const char* p) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+        return value;
+    }
+
+    bool read_all(int fd, char* data, size_t len) {
+        while (len > 0) {
+            ssize_t got = ::read(fd, data, len);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            data += got;
+            len -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    bool write_all(int fd, const char* data, size_t len) {
+        while (len > 0) {
+            ssize_t put = ::write(fd, data, len);
+            if (put < 0 && errno == EINTR) continue;
+            if (put <= 0) return false;
+            data += put;
+            len -= static_cast<size_t>(put);
+        }
+        return true;
+    }
+
+    Graph parse_graph(const SolveRequest& request) {
+        if (request.format == PayloadFormat::EDGE_LIST) {
+            std::istringstream in(request.payload);
+            return Graph::from_edge_list(in);
+        }
+
+        const std::string& p = request.payload;
+        if (p.size() < 8) throw std::runtime_error("binary graph: missing header");
+        uint32_t n = get_u32(p.data()), m = get_u32(p.data() + 4);
+        if (n > INT_MAX || p.size() != 8 + 8 * static_cast<uint64_t>(m)) {
+            throw std::runtime_error("binary graph: size does not match n and m");
+        }
+        std::vector<Edge> edges(m);
+        for (uint32_t i = 0; i < m; ++i) {
+            const char* e = p.data() + 8 + 8 * static_cast<size_t>(i);
+            uint32_t u = get_u32(e), v = get_u32(e + 4);
+            if (u >= n || v >= n) throw std::out_of_range("binary graph: vertex id out of range");
+            edges[i] = Edge{static_cast<int>(u), static_cast<int>(v)};
+        }
+        // one thread: the pool already runs one request per core
+        return CsrGraph::from_edges(static_cast<int>(n), edges, 1).to_graph();
+    }
+
+    // Per-stream state shared with the replies still in flight
+    struct Stream {
+        int fd;
+        std::mutex mutex;
+        std::condition_variable idle;
+        int pending = 0;
+    };
+
+    // Stamps the time spent in the worker
+    SolveResponse finish(SolveResponse& response, std::chrono::steady_clock::time_point start) {
+        response.solve_us = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        return response;
+    }
+
+} // namespace
+
+const char* response_status_name(ResponseStatus status) {
+    switch (status) {
+        case ResponseStatus::COLORED:       return "colored";
+        case ResponseStatus::NOT_COLORABLE: return "not-colorable";
+        case ResponseStatus::FAILED:        return "failed";
+        case ResponseStatus::TIMEOUT:       return "timeout";
+        case ResponseStatus::CANCELLED:     return "cancelled";
+        case ResponseStatus::BAD_REQUEST:   return "bad-request";
+        case ResponseStatus::BUSY:          return "busy";
+    }
+    return "unknown";
+}
+
+ServiceSolver parse_service_solver(const std::string& name) {
+    if (name == "greedy") return ServiceSolver::GREEDY;
+    if (name == "cdcl")   return ServiceSolver::CDCL;
+    if (name == "auto")   return ServiceSolver::AUTO;
+    throw std::invalid_argument("Unknown solver: " + name);
+}
+
+std::string encode_request(const SolveRequest& request) {
+    std::string out;
+    out.reserve(kRequestHeader + request.payload.size());
+    put_u64(out, request.id);
+    out.push_back(static_cast<char>(request.type));
+    out.push_back(static_cast<char>(request.solver));
+    out.push_back(static_cast<char>(request.format));
+    out.push_back(0);
+    put_u32(out, request.deadline_ms);
+    out += request.payload;
+    return out;
+}
+
+bool decode_request(const std::string& body, SolveRequest& request) {
+    if (body.size() < kRequestHeader) return false;
+    uint8_t type = static_cast<uint8_t>(body[8]);
+    uint8_t solver = static_cast<uint8_t>(body[9]);
+    uint8_t format = static_cast<uint8_t>(body[10]);
+    if (type > 2 || solver > 2 || format > 1) return false;
+    request.id = get_u64(body.data());
+    request.type = static_cast<RequestType>(type);
+    request.solver = static_cast<ServiceSolver>(solver);
+    request.format = static_cast<PayloadFormat>(format);
+    request.deadline_ms = get_u32(body.data() + 12);
+    request.payload.assign(body, kRequestHeader, std::string::npos);
+    return true;
+}
+
+std::string encode_response(const SolveResponse& response) {
+    std::string out;
+    out.reserve(kResponseHeader + response.data.size());
+    put_u64(out, response.id);
+    out.push_back(static_cast<char>(response.status));
+    out.append(3, '\0');
+    put_u32(out, response.solve_us);
+    put_u32(out, static_cast<uint32_t>(response.data.size()));
+    out += response.data;
+    return out;
+}
+
+bool decode_response(const std::string& body, SolveResponse& response) {
+    if (body.size() < kResponseHeader) return false;
+    uint8_t status = static_cast<uint8_t>(body[8]);
+    uint32_t size = get_u32(body.data() + 16);
+    if (status > static_cast<uint8_t>(ResponseStatus::BUSY) || body.size() != kResponseHeader + size) return false;
+    response.id = get_u64(body.data());
+    response.status = static_cast<ResponseStatus>(status);
+    response.solve_us = get_u32(body.data() + 12);
+    response.data.assign(body, kResponseHeader, size);
+    return true;
+}
+
+std::string encode_binary_graph(int n, const std::vector<std::pair<int, int>>& edges) {
+    std::string out;
+    out.reserve(8 + 8 * edges.size());
+    put_u32(out, static_cast<uint32_t>(n));
+    put_u32(out, static_cast<uint32_t>(edges.size()));
+    for (const auto& e : edges) {
+        put_u32(out, static_cast<uint32_t>(e.first));
+        put_u32(out, static_cast<uint32_t>(e.second));
+    }
+    return out;
+}
+
+bool read_frame(int fd, std::string& body) {
+    char prefix[4];
+    if (!read_all(fd, prefix, sizeof(prefix))) return false;
+    uint32_t len = get_u32(prefix);
+    if (len > kMaxFrame) return false;
+    body.resize(len);
+    return read_all(fd, &body[0], len);
+}
+
+bool write_frame(int fd, const std::string& body) {
+    std::string prefix;
+    put_u32(prefix, static_cast<uint32_t>(body.size()));
+    return write_all(fd, prefix.data(), prefix.size()) && write_all(fd, body.data(), body.size());
+}
+
+SolveService::SolveService(const ServiceOptions& options)
+    : options_(options), stopping_(false)
+{
+    int workers = options_.workers > 0 ? options_.workers : default_thread_count();
+    for (int t = 0; t < workers; ++t) workers_.emplace_back([this] { worker_loop(); });
+}
+
+SolveService::~SolveService() {
+    std::vector<Job> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        for (auto& job : queue_) dropped.push_back(std::move(job));
+        queue_.clear();
+        for (auto& entry : running_) entry.second->store(true);
+    }
+    ready_.notify_all();
+    for (auto& job : dropped) job.reply(SolveResponse{job.request.id, ResponseStatus::CANCELLED, 0, ""});
+    for (auto& w : workers_) w.join();
+}
+
+void SolveService::submit(const void* owner, SolveRequest request, Reply reply) {
+    Job job;
+    job.key = Key(owner, request.id);
+    job.deadline = request.deadline_ms > 0 ? Clock::now() + std::chrono::milliseconds(request.deadline_ms)
+                                           : Clock::time_point::max();
+    job.stop = std::make_shared<std::atomic<bool>>(false);
+    job.request = std::move(request);
+    job.reply = std::move(reply);
+
+    bool busy = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || queue_.size() >= options_.max_queue) busy = true;
+        else queue_.push_back(std::move(job));
+    }
+    if (busy) {
+        job.reply(SolveResponse{job.request.id, ResponseStatus::BUSY, 0, ""});
+        return;
+    }
+    ready_.notify_one();
+}
+
+bool SolveService::cancel_locked(const Key& key, std::vector<Job>& dropped) {
+    for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+        if (it->key == key) {
+            dropped.push_back(std::move(*it));
+            queue_.erase(it);
+            return true;
+        }
+    }
+    auto running = running_.find(key);
+    if (running == running_.end()) return false;
+    running->second->store(true);
+    return true;
+}
+
+bool SolveService::cancel(const void* owner, uint64_t id) {
+    std::vector<Job> dropped;
+    bool found;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        found = cancel_locked(Key(owner, id), dropped);
+    }
+    for (auto& job : dropped) job.reply(SolveResponse{job.request.id, ResponseStatus::CANCELLED, 0, ""});
+    return found;
+}
+
+void SolveService::cancel_all(const void* owner) {
+    std::vector<Job> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = queue_.begin(); it != queue_.end();) {
+            if (it->key.first == owner) {
+                dropped.push_back(std::move(*it));
+                it = queue_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        for (auto& entry : running_) {
+            if (entry.first.first == owner) entry.second->store(true);
+        }
+    }
+    for (auto& job : dropped) job.reply(SolveResponse{job.request.id, ResponseStatus::CANCELLED, 0, ""});
+}
+
+void SolveService::worker_loop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            running_[job.key] = job.stop;
+        }
+
+        SolveResponse response{job.request.id, ResponseStatus::CANCELLED, 0, ""};
+        if (!job.stop->load()) {
+            if (Clock::now() >= job.deadline) {
+                response.status = ResponseStatus::TIMEOUT;
+            } else {
+                if (options_.on_start) options_.on_start(job.request.id);
+                response = solve(job);
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = running_.find(job.key);
+            if (it != running_.end() && it->second == job.stop) running_.erase(it);
+        }
+        job.reply(response);
+    }
+}
+
+SolveResponse SolveService::solve(const Job& job) const {
+    auto start = Clock::now();
+    SolveResponse response{job.request.id, ResponseStatus::FAILED, 0, ""};
+    // checked between stages that leave the request unsettled; none of them is interrupted
+    auto expired = [&] {
+        if (job.stop->load()) response.status = ResponseStatus::CANCELLED;
+        else if (Clock::now() >= job.deadline) response.status = ResponseStatus::TIMEOUT;
+        else return false;
+        return true;
+    };
+    try {
+        Graph g = parse_graph(job.request);
+        if (expired()) return finish(response, start);
+
+        UnsatFilterOptions filter;
+        filter.k4_work_limit = options_.filter_work_limit;
+        filter.odd_wheel_work_limit = options_.filter_work_limit;
+        bool unsat = find_unsat_witness(g, filter).found();
+        if (!unsat && expired()) return finish(response, start);
+
+        if (unsat) {
+            response.status = ResponseStatus::NOT_COLORABLE;
+        } else {
+            bool colored = false;
+            if (job.request.solver != ServiceSolver::CDCL) {
+                colored = run_greedy_with_policy(g, PolicyConfig());
+            }
+            if (!colored && job.request.solver != ServiceSolver::GREEDY) {
+                if (expired()) return finish(response, start);
+                g.reset_coloring_state();
+                CdclOptions options;
+                options.deadline = job.deadline;
+                options.stop = job.stop.get();
+                CdclSolver cdcl(g, options);
+                SolveStatus status = cdcl.solve();
+                colored = status == SolveStatus::SATISFIABLE;
+                if (status == SolveStatus::UNSATISFIABLE) response.status = ResponseStatus::NOT_COLORABLE;
+                if (status == SolveStatus::UNKNOWN) {
+                    response.status = job.stop->load() ? ResponseStatus::CANCELLED : ResponseStatus::TIMEOUT;
+                }
+            }
+            if (colored && verify_coloring_parallel(g, 1).valid) {
+                response.status = ResponseStatus::COLORED;
+                response.data.resize(g.num_vertices());
+                for (int v = 0; v < g.num_vertices(); ++v) response.data[v] = static_cast<char>(g.vertex(v).color);
+            }
+        }
+    } catch (const std::exception& ex) {
+        response.status = ResponseStatus::BAD_REQUEST;
+        response.data = ex.what();
+    }
+    return finish(response, start);
+}
+
+bool serve_stream(SolveService& service, int in_fd, int out_fd) {
+    // replies come from worker threads; each one holds the stream until it is written
+    auto stream = std::make_shared<Stream>();
+    stream->fd = out_fd;
+    auto reply = [stream](const SolveResponse& response) {
+        std::lock_guard<std::mutex> lock(stream->mutex);
+        write_frame(stream->fd, encode_response(response));
+        if (--stream->pending == 0) stream->idle.notify_all();
+    };
+
+    bool shutting_down = false;
+    std::string body;
+    while (!shutting_down && read_frame(in_fd, body)) {
+        SolveRequest request;
+        if (!decode_request(body, request)) {
+            std::lock_guard<std::mutex> lock(stream->mutex);
+            write_frame(out_fd, encode_response(SolveResponse{0, ResponseStatus::BAD_REQUEST, 0, "malformed request"}));
+            continue;
+        }
+        switch (request.type) {
+            case RequestType::SOLVE:
+                {
+                    std::lock_guard<std::mutex> lock(stream->mutex);
+                    ++stream->pending;
+                }
+                service.submit(stream.get(), std::move(request), reply);
+                break;
+            case RequestType::CANCEL:
+                service.cancel(stream.get(), request.id);
+                break;
+            case RequestType::SHUTDOWN:
+                shutting_down = true;
+                break;
+        }
+    }
+
+    // the input ended without SHUTDOWN: the peer is gone, so stop its work
+    // instead of solving requests nobody will read; cancelled jobs still reply
+    if (!shutting_down) service.cancel_all(stream.get());
+
+    // answer what is still in flight
+    std::unique_lock<std::mutex> lock(stream->mutex);
+    stream->idle.wait(lock, [&] { return stream->pending == 0; });
+    return shutting_down;
+}
+
+void serve_unix_socket(SolveService& service, const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) throw std::runtime_error("Could not create socket");
+    ::unlink(path.c_str());
+    if (::bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(listen_fd, 64) != 0) {
+        ::close(listen_fd);
+        throw std::runtime_error("Could not listen on " + path + ": " + std::strerror(errno));
+    }
+
+    // connection threads are detached; the last one to finish wakes the exit below
+    std::mutex mutex;
+    std::condition_variable done;
+    std::set<int> open;
+    bool stopping = false;
+
+    while (true) {
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break; // shut down by a SHUTDOWN request
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            ::close(fd);
+            break;
+        }
+        open.insert(fd);
+        std::thread([&, fd] {
+            bool shutting_down = serve_stream(service, fd, fd);
+            std::lock_guard<std::mutex> guard(mutex);
+            if (shutting_down && !stopping) {
+                stopping = true;
+                ::shutdown(listen_fd, SHUT_RDWR);           // wakes accept()
+                for (int other : open) ::shutdown(other, SHUT_RD); // ends the other readers
+            }
+            open.erase(fd);
+            ::close(fd);
+            done.notify_all();
+        }).detach();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return open.empty(); });
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+}
+
+int connect_unix_socket(const std::string& path) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + path);
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (fd >= 0) ::close(fd);
+        throw std::runtime_error("Could not connect to " + path + ": " + std::strerror(errno));
+    }
+    return fd;
+}
+
+} // namespace threecolor
@@ -12,10 +12,12 @@ Implementation of sorting_machine.hpp
 
 namespace threecolor {
 
-    SortingMachine::SortingMachine()
+    template <class TieBreak>
+    BasicSortingMachine<TieBreak>::BasicSortingMachine()
         : graph(nullptr) {}
 
-    void SortingMachine::initialize(Graph& g) {
+    template <class TieBreak>
+    void BasicSortingMachine<TieBreak>::initialize(Graph& g) {
         graph = &g;
 
         // Tracks the number of vertices in the graph
@@ -62,21 +64,24 @@ namespace threecolor {
         }
     }
 
-    bool SortingMachine::empty() const {
+    template <class TieBreak>
+    bool BasicSortingMachine<TieBreak>::empty() const {
         for (const auto& bucket : buckets) {
             if (bucket.head != nullptr) return false;
         }
         return true;
     }
 
-    int SortingMachine::find_bucket_index_for_degree(int degree) const {
+    template <class TieBreak>
+    int BasicSortingMachine<TieBreak>::find_bucket_index_for_degree(int degree) const {
         if (degree < 0 || degree >= static_cast<int>(degree_to_bucket.size())) {
             return -1;
         }
         return degree_to_bucket[degree];
     }
 
-    void SortingMachine::insert(Vertex* v) {
+    template <class TieBreak>
+    void BasicSortingMachine<TieBreak>::insert(Vertex* v) {
         if (!graph || !v) return;
         if (v->color != UNCOLORED) return; // only uncolored vertices
 
@@ -89,10 +94,10 @@ namespace threecolor {
         Vertex* cur = B.head;
         Vertex* prev = nullptr;
 
-        // Order by colored_neighbors descending, tie-break by id ascending
+        // Order by colored_neighbors descending, tie-break by policy (id ascending by default)
         while (cur != nullptr && 
                (cur->colored_neighbors > v->colored_neighbors || 
-               (cur->colored_neighbors == v->colored_neighbors && cur->id < v->id))) {
+               (cur->colored_neighbors == v->colored_neighbors && TieBreak::before(cur, v)))) {
             prev = cur;
             cur = cur->next_in_bucket;
         }
@@ -106,7 +111,8 @@ namespace threecolor {
         if(cur) cur->prev_in_bucket = v;
     }
 
-    void SortingMachine::remove(Vertex* v) {
+    template <class TieBreak>
+    void BasicSortingMachine<TieBreak>::remove(Vertex* v) {
         if (!graph || !v) return;
         int index = find_bucket_index_for_degree(v->degree);
         if(index < 0) return;
@@ -125,7 +131,8 @@ namespace threecolor {
     }
 
     // Removes vertex from bucket, increments colored-neighbor count, inserts back in
-    void SortingMachine::bump_colored_neighbors(Vertex* v) {
+    template <class TieBreak>
+    void BasicSortingMachine<TieBreak>::bump_colored_neighbors(Vertex* v) {
         if(!graph || !v) return;
         if(v->color != UNCOLORED) return;
 
@@ -134,7 +141,8 @@ namespace threecolor {
         insert(v);
     }
     
-    Vertex* SortingMachine::pick_next_vertex() {
+    template <class TieBreak>
+    Vertex* BasicSortingMachine<TieBreak>::pick_next_vertex() {
         for(auto& bucket : buckets) {
             //Skip over already colored vertices if any somehow remain
             while(bucket.head && bucket.head->color != UNCOLORED) {
@@ -145,4 +153,7 @@ namespace threecolor {
         }
         return nullptr; // all vertices colored
     }
+
+    template class BasicSortingMachine<LowerIdFirst>;
+    template class BasicSortingMachine<HigherIdFirst>;
 } // namespace threecolor
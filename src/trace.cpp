@@ -0,0 +1,134 @@
+/*
+trace.cpp
+
+Author: Dialo Sall
+
+Implementation of trace.hpp
+Double-buffered writer: the solver fills one buffer while the writer thread
+spills the other one to disk
+
+*/
+#include "trace.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace threecolor {
+
+    TraceRecorder::TraceRecorder(const std::string& path, int num_vertices, size_t buffer_records)
+        : path_(path), file_(nullptr), capacity_(buffer_records > 0 ? buffer_records : 1),
+          active_(nullptr), active_size_(0), active_index_(0), total_records_(0),
+          pending_index_(-1), pending_size_(0), write_failed_(false), stopping_(false), closed_(false)
+    {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_) {
+            throw std::runtime_error("Could not open trace file: " + path);
+        }
+
+        TraceHeader header;
+        std::memcpy(header.magic, "3CTR", 4);
+        header.version = 1;
+        header.record_size = sizeof(TraceRecord);
+        header.num_vertices = num_vertices;
+        if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+            std::fclose(file_);
+            throw std::runtime_error("Could not write trace file: " + path);
+        }
+
+        // Allocate both buffers up front so record() never allocates
+        buffers_[0].resize(capacity_);
+        buffers_[1].resize(capacity_);
+        active_ = buffers_[0].data();
+
+        writer_ = std::thread(&TraceRecorder::writer_loop, this);
+    }
+
+    TraceRecorder::~TraceRecorder() {
+        // destructors must not throw; call close() directly to see write errors
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+
+    // Gives the full active buffer to the writer and switches to the other one
+    void TraceRecorder::hand_off_active() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // only blocks if the writer is still busy with the previous buffer
+        cv_.wait(lock, [this] { return pending_index_ == -1; });
+        pending_index_ = active_index_;
+        pending_size_ = active_size_;
+        cv_.notify_all();
+
+        active_index_ ^= 1;
+        active_ = buffers_[active_index_].data();
+        active_size_ = 0;
+    }
+
+    void TraceRecorder::writer_loop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this] { return pending_index_ != -1 || stopping_; });
+            if (pending_index_ == -1) break; // stopping with nothing left
+
+            int index = pending_index_;
+            size_t size = pending_size_;
+
+            // the buffer stays owned by the writer until pending_index_ is cleared
+            lock.unlock();
+            size_t wrote = std::fwrite(buffers_[index].data(), sizeof(TraceRecord), size, file_);
+            lock.lock();
+
+            if (wrote != size) write_failed_ = true; // reported by close()
+
+            pending_index_ = -1;
+            cv_.notify_all();
+        }
+    }
+
+    void TraceRecorder::close() {
+        if (closed_) return;
+        closed_ = true;
+
+        if (active_size_ > 0) {
+            hand_off_active();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        writer_.join();
+
+        // fclose flushes the stdio buffer, so it can fail too
+        bool failed = write_failed_;
+        if (std::fclose(file_) != 0) failed = true;
+        file_ = nullptr;
+        if (failed) {
+            throw std::runtime_error("Could not write trace file: " + path_);
+        }
+    }
+
+    std::vector<TraceRecord> read_trace(const std::string& path, TraceHeader& header) {
+        std::FILE* in = std::fopen(path.c_str(), "rb");
+        if (!in) {
+            throw std::runtime_error("Could not open trace file: " + path);
+        }
+
+        if (std::fread(&header, sizeof(header), 1, in) != 1 ||
+            std::memcmp(header.magic, "3CTR", 4) != 0 ||
+            header.record_size != sizeof(TraceRecord)) {
+            std::fclose(in);
+            throw std::runtime_error("Not a 3-color trace file: " + path);
+        }
+
+        std::vector<TraceRecord> records;
+        TraceRecord chunk[4096];
+        size_t got;
+        while ((got = std::fread(chunk, sizeof(TraceRecord), 4096, in)) > 0) {
+            records.insert(records.end(), chunk, chunk + got);
+        }
+        std::fclose(in);
+        return records;
+    }
+
+} // namespace threecolor
@@ -0,0 +1,109 @@
+/*
+trace_tool.cpp
+
+Author: Dialo Sall
+
+Offline reader for traces written by color3 --trace
+    trace_tool summary trace.bin
+        Prints step counts, trapped vs. sorting machine picks, colors used,
+        trapping totals and where the run failed (if it did)
+    trace_tool frames trace.bin graph.txt prefix
+        Writes prefix_0000.dot, prefix_0001.dot, ... one DOT frame per step
+        The graph file must be the same one the trace was recorded on
+*/
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "trace.hpp"
+#include "utilities.hpp"
+
+using namespace threecolor;
+
+static void print_summary(const TraceHeader& header, const std::vector<TraceRecord>& records) {
+    uint64_t from_trapped = 0;
+    uint64_t from_machine = 0;
+    uint64_t total_trapped = 0;
+    uint64_t color_counts[3] = {0, 0, 0};
+    int longest_trapped_run = 0;
+    int current_run = 0;
+    const TraceRecord* failure = nullptr;
+
+    for (const TraceRecord& r : records) {
+        if (r.source == SOURCE_TRAPPED) {
+            ++from_trapped;
+            ++current_run;
+            if (current_run > longest_trapped_run) longest_trapped_run = current_run;
+        } else {
+            ++from_machine;
+            current_run = 0;
+        }
+        if (r.color >= 0 && r.color < 3) ++color_counts[r.color];
+        total_trapped += static_cast<uint64_t>(r.newly_trapped);
+        if (r.contradiction) failure = &r;
+    }
+
+    std::cout << "Vertices:              " << header.num_vertices << "\n";
+    std::cout << "Steps:                 " << records.size() << "\n";
+    std::cout << "Picked from trapped:   " << from_trapped << "\n";
+    std::cout << "Picked from machine:   " << from_machine << "\n";
+    std::cout << "Longest trapped chain: " << longest_trapped_run << "\n";
+    std::cout << "Vertices trapped:      " << total_trapped << "\n";
+    std::cout << "Colors (R/B/Y):        " << color_counts[RED] << "/"
+              << color_counts[BLUE] << "/" << color_counts[YELLOW] << "\n";
+    if (failure) {
+        std::cout << "Result:                Failure at step " << failure->step
+                  << " (vertex " << failure->vertex << ")\n";
+    } else {
+        std::cout << "Result:                Success\n";
+    }
+}
+
+static void write_frames(const std::vector<TraceRecord>& records, Graph& g, const std::string& prefix) {
+    g.reset_coloring_state();
+    char name[32];
+    for (size_t i = 0; i < records.size(); ++i) {
+        const TraceRecord& r = records[i];
+        if (r.vertex < 0 || r.vertex >= g.num_vertices()) {
+            throw std::runtime_error("Trace does not match graph: vertex out of range");
+        }
+        g.vertex(r.vertex).color = static_cast<Color>(r.color);
+
+        std::snprintf(name, sizeof(name), "_%04zu.dot", i);
+        export_to_dot(g, prefix + name);
+    }
+    std::cout << "Wrote " << records.size() << " frames to " << prefix << "_*.dot\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " summary trace.bin\n"
+                  << "       " << argv[0] << " frames trace.bin graph.txt prefix\n";
+        return 1;
+    }
+
+    try {
+        std::string mode = argv[1];
+        TraceHeader header;
+        std::vector<TraceRecord> records = read_trace(argv[2], header);
+
+        if (mode == "summary") {
+            print_summary(header, records);
+        } else if (mode == "frames" && argc >= 5) {
+            Graph g = Graph::from_edge_list_file(argv[3]);
+            if (g.num_vertices() != header.num_vertices) {
+                throw std::runtime_error("Trace does not match graph: vertex count differs");
+            }
+            write_frames(records, g, argv[4]);
+        } else {
+            std::cerr << "Unknown mode: " << mode << "\n";
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,268 @@
+/*
+unsat_filter.cpp
+
+Author: Dialo Sall
+
+Implementation of unsat_filter.hpp
+
+K4 search:
+    1. Rank vertices by degree (ties by id) and keep only edges pointing to a
+       higher rank, so every triangle is listed exactly once and forward lists
+       stay short even around hubs
+    2. For each u, set a bit for every forward neighbor of u
+    3. For each forward neighbor v, the forward neighbors of v with their bit
+       set close triangles u-v-w
+    4. Two of those w's that are adjacent complete a K4
+    Stops once the forward lists scanned in 3 and 4 pass the work limit
+
+Odd wheel search:
+    For each hub h (highest degree first), try to 2-color the subgraph induced
+    by N(h) with a BFS. An edge inside one BFS layer parity is an odd cycle, and
+    h plus that cycle is an odd wheel.
+*/
+#include "unsat_filter.hpp"
+#include "csr_graph.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace threecolor {
+
+namespace {
+
+    // Fixed-size bitset over vertex ids
+    struct VertexBits {
+        std::vector<uint64_t> words;
+
+        explicit VertexBits(int n) : words((static_cast<size_t>(n) + 63) / 64, 0) {}
+
+        void set(int i)        { words[i >> 6] |= (1ULL << (i & 63)); }
+        void clear(int i)      { words[i >> 6] &= ~(1ULL << (i & 63)); }
+        bool test(int i) const { return (words[i >> 6] >> (i & 63)) & 1ULL; }
+    };
+
+    UnsatWitness make_k4(int a, int b, int c, int d) {
+        UnsatWitness w;
+        w.kind = WitnessKind::K4;
+        w.vertices = {a, b, c, d};
+        for (int i = 0; i < 4; ++i) {
+            for (int j = i + 1; j < 4; ++j) {
+                w.edges.emplace_back(w.vertices[i], w.vertices[j]);
+            }
+        }
+        return w;
+    }
+
+    UnsatWitness find_k4(const Graph& g, const CsrGraph& adj, uint64_t work_limit) {
+        int n = g.num_vertices();
+
+        // rank[v] = position in ascending (degree, id) order
+        std::vector<int> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](int a, int b) {
+            int da = adj.degree(a), db = adj.degree(b);
+            return da != db ? da < db : a < b;
+        });
+        std::vector<int> rank(n);
+        for (int i = 0; i < n; ++i) rank[order[i]] = i;
+
+        // forward adjacency: only neighbors of higher rank
+        std::vector<int> fwd_offsets(n + 1, 0);
+        for (int v = 0; v < n; ++v) {
+            int count = 0;
+            for (const int* p = adj.begin(v); p != adj.end(v); ++p) {
+                if (rank[*p] > rank[v]) ++count;
+            }
+            fwd_offsets[v + 1] = fwd_offsets[v] + count;
+        }
+        std::vector<int> fwd(fwd_offsets[n]);
+        for (int v = 0; v < n; ++v) {
+            int pos = fwd_offsets[v];
+            for (const int* p = adj.begin(v); p != adj.end(v); ++p) {
+                if (rank[*p] > rank[v]) fwd[pos++] = *p;
+            }
+        }
+
+        VertexBits in_fwd_u(n);   // forward neighbors of u
+        VertexBits in_common(n);  // vertices closing a triangle with u-v
+        std::vector<int> common;
+        uint64_t work = 0;
+
+        for (int u = 0; u < n; ++u) {
+            int ub = fwd_offsets[u], ue = fwd_offsets[u + 1];
+            if (ue - ub < 3) continue; // u needs three forward neighbors to lead a K4
+            for (int i = ub; i < ue; ++i) in_fwd_u.set(fwd[i]);
+
+            for (int i = ub; i < ue; ++i) {
+                int v = fwd[i];
+                common.clear();
+                work += fwd_offsets[v + 1] - fwd_offsets[v];
+                for (int j = fwd_offsets[v]; j < fwd_offsets[v + 1]; ++j) {
+                    if (in_fwd_u.test(fwd[j])) common.push_back(fwd[j]);
+                }
+                if (common.size() < 2) continue;
+
+                for (int w : common) in_common.set(w);
+                for (int w : common) {
+                    work += fwd_offsets[w + 1] - fwd_offsets[w];
+                    for (int j = fwd_offsets[w]; j < fwd_offsets[w + 1]; ++j) {
+                        int x = fwd[j];
+                        if (in_common.test(x)) {
+                            return make_k4(u, v, w, x);
+                        }
+                    }
+                }
+                for (int w : common) in_common.clear(w);
+            }
+
+            for (int i = ub; i < ue; ++i) in_fwd_u.clear(fwd[i]);
+            if (work_limit > 0 && work >= work_limit) break;
+        }
+
+        return UnsatWitness{WitnessKind::NONE, {}, {}};
+    }
+
+    UnsatWitness find_odd_wheel(const Graph& g, const CsrGraph& adj, uint64_t work_limit) {
+        int n = g.num_vertices();
+
+        std::vector<int> hubs(n);
+        std::iota(hubs.begin(), hubs.end(), 0);
+        std::sort(hubs.begin(), hubs.end(), [&](int a, int b) {
+            int da = adj.degree(a), db = adj.degree(b);
+            return da != db ? da > db : a < b;
+        });
+
+        VertexBits in_rim(n);            // N(hub)
+        std::vector<int8_t> side(n, -1); // BFS parity inside N(hub)
+        std::vector<int> parent(n, -1);
+        std::vector<int> queue;
+        uint64_t work = 0;
+
+        for (int h : hubs) {
+            if (adj.degree(h) < 3) break; // sorted, so no later hub qualifies
+            for (const int* p = adj.begin(h); p != adj.end(h); ++p) in_rim.set(*p);
+
+            int bad_x = -1, bad_y = -1;
+            for (const int* r = adj.begin(h); r != adj.end(h) && bad_x < 0; ++r) {
+                if (side[*r] != -1) continue;
+                side[*r] = 0;
+                parent[*r] = -1;
+                queue.assign(1, *r);
+
+                for (size_t qi = 0; qi < queue.size() && bad_x < 0; ++qi) {
+                    int x = queue[qi];
+                    for (const int* p = adj.begin(x); p != adj.end(x); ++p) {
+                        ++work;
+                        int y = *p;
+                        if (!in_rim.test(y)) continue;
+                        if (side[y] == -1) {
+                            side[y] = static_cast<int8_t>(1 - side[x]);
+                            parent[y] = x;
+                            queue.push_back(y);
+                        } else if (side[y] == side[x]) {
+                            bad_x = x;
+                            bad_y = y;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            UnsatWitness result{WitnessKind::NONE, {}, {}};
+            if (bad_x >= 0) {
+                // walk both endpoints up the BFS tree to their lowest common ancestor
+                std::vector<int> path_x, path_y;
+                for (int x = bad_x; x != -1; x = parent[x]) path_x.push_back(x);
+                for (int y = bad_y; y != -1; y = parent[y]) path_y.push_back(y);
+                while (path_x.size() > 1 && path_y.size() > 1 &&
+                       path_x[path_x.size() - 2] == path_y[path_y.size() - 2]) {
+                    path_x.pop_back();
+                    path_y.pop_back();
+                }
+                // path_x and path_y now both end at the common ancestor
+                result.kind = WitnessKind::ODD_WHEEL;
+                result.vertices.push_back(h);
+                result.vertices.insert(result.vertices.end(), path_x.begin(), path_x.end());
+                result.vertices.insert(result.vertices.end(), path_y.rbegin() + 1, path_y.rend());
+
+                int rim = static_cast<int>(result.vertices.size()) - 1;
+                for (int i = 1; i <= rim; ++i) {
+                    result.edges.emplace_back(h, result.vertices[i]);
+                    int next = i == rim ? 1 : i + 1;
+                    result.edges.emplace_back(result.vertices[i], result.vertices[next]);
+                }
+            }
+
+            for (const int* p = adj.begin(h); p != adj.end(h); ++p) {
+                in_rim.clear(*p);
+                side[*p] = -1;
+            }
+            if (result.found()) return result;
+            if (work_limit > 0 && work >= work_limit) break;
+        }
+
+        return UnsatWitness{WitnessKind::NONE, {}, {}};
+    }
+
+} // namespace
+
+UnsatWitness find_unsat_witness(const Graph& g, const UnsatFilterOptions& options) {
+    CsrGraph adj = CsrGraph::from_graph(g, 1);
+
+    if (options.find_k4) {
+        UnsatWitness w = find_k4(g, adj, options.k4_work_limit);
+        if (w.found()) return w;
+    }
+    if (options.find_odd_wheels) {
+        UnsatWitness w = find_odd_wheel(g, adj, options.odd_wheel_work_limit);
+        if (w.found()) return w;
+    }
+    return UnsatWitness{WitnessKind::NONE, {}, {}};
+}
+
+bool witness_is_valid(const Graph& g, const UnsatWitness& witness) {
+    int n = g.num_vertices();
+    auto adjacent = [&](int a, int b) {
+        if (a < 0 || a >= n || b < 0 || b >= n) return false;
+        return !g.for_each_neighbor(a, [&](int w) { return w != b; });
+    };
+
+    const std::vector<int>& vs = witness.vertices;
+    std::vector<int> sorted(vs);
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) return false;
+
+    if (witness.kind == WitnessKind::K4) {
+        if (vs.size() != 4) return false;
+        for (int i = 0; i < 4; ++i) {
+            for (int j = i + 1; j < 4; ++j) {
+                if (!adjacent(vs[i], vs[j])) return false;
+            }
+        }
+    } else if (witness.kind == WitnessKind::ODD_WHEEL) {
+        // hub, then the rim in cycle order: odd, at least 3, closing back on vs[1]
+        size_t rim = vs.size() - 1;
+        if (vs.size() < 4 || rim % 2 == 0) return false;
+        for (size_t i = 1; i <= rim; ++i) {
+            if (!adjacent(vs[0], vs[i])) return false;
+            if (!adjacent(vs[i], vs[i == rim ? 1 : i + 1])) return false;
+        }
+    } else {
+        return false;
+    }
+
+    for (const auto& e : witness.edges) {
+        if (!adjacent(e.first, e.second)) return false;
+    }
+    return true;
+}
+
+const char* witness_kind_name(WitnessKind kind) {
+    switch (kind) {
+        case WitnessKind::K4:        return "K4";
+        case WitnessKind::ODD_WHEEL: return "odd wheel";
+        case WitnessKind::NONE:      break;
+    }
+    return "none";
+}
+
+} // namespace threecolor
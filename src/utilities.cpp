@@ -1,6 +1,7 @@
 #include "utilities.hpp"
+#include "buffered_writer.hpp"
 #include <random>
-#include <fstream>
+#include <stdexcept>
 #include <string>
 
 namespace threecolor {
@@ -20,10 +21,103 @@ Graph generate_random_graph(int n, double p, std::mt19937& rng) {
     return g;
 }
 
-// exports graphs to .dot file for visualization
-void export_to_dot(const Graph& g, const std::string& path) {
-    std::ofstream out(path);
-    out << "graph G {\n";
+// Creates random graphs with a hidden valid 3-coloring
+Graph generate_planted_graph(int n, double p, std::mt19937& rng, std::vector<Color>* planted) {
+    std::uniform_int_distribution<int> color_dist(0, 2);
+    std::bernoulli_distribution edge_dist(p);
+
+    std::vector<Color> hidden(n);
+    for (int u = 0; u < n; ++u) {
+        hidden[u] = static_cast<Color>(color_dist(rng));
+    }
+
+    Graph g(n);
+    for (int u = 0; u < n; ++u) {
+        for (int v = u + 1; v < n; ++v) {
+            if (hidden[u] != hidden[v] && edge_dist(rng)) {
+                g.add_edge(u, v);
+            }
+        }
+    }
+    g.compute_degrees();
+
+    if (planted) *planted = hidden;
+    return g;
+}
+
+// Calls fn(u, v) for each pair u < v independently with probability p, in
+// increasing (u, v) order. Jumps straight to the next chosen pair with a
+// geometric skip, so sparse graphs cost O(n + edges) instead of O(n^2)
+template <class Fn>
+static void for_each_random_pair(int n, double p, std::mt19937& rng, Fn fn) {
+    if (p <= 0.0) return;
+    if (p >= 1.0) {
+        for (int u = 0; u < n; ++u) {
+            for (int v = u + 1; v < n; ++v) fn(u, v);
+        }
+        return;
+    }
+
+    std::geometric_distribution<long long> skip(p);
+    for (int u = 0; u < n; ++u) {
+        long long v = u + 1 + skip(rng);
+        while (v < n) {
+            fn(u, static_cast<int>(v));
+            v += 1 + skip(rng);
+        }
+    }
+}
+
+Graph generate_sparse_random_graph(int n, double p, std::mt19937& rng) {
+    Graph g(n);
+    for_each_random_pair(n, p, rng, [&](int u, int v) { g.add_edge(u, v); });
+    g.compute_degrees();
+    return g;
+}
+
+Graph generate_sparse_planted_graph(int n, double p, std::mt19937& rng, std::vector<Color>* planted) {
+    std::uniform_int_distribution<int> color_dist(0, 2);
+
+    std::vector<Color> hidden(n);
+    for (int u = 0; u < n; ++u) {
+        hidden[u] = static_cast<Color>(color_dist(rng));
+    }
+
+    Graph g(n);
+    for_each_random_pair(n, p, rng, [&](int u, int v) {
+        if (hidden[u] != hidden[v]) g.add_edge(u, v);
+    });
+    g.compute_degrees();
+
+    if (planted) *planted = hidden;
+    return g;
+}
+
+ExportFormat parse_export_format(const std::string& name) {
+    if (name == "none")   return ExportFormat::NONE;
+    if (name == "dot")    return ExportFormat::DOT;
+    if (name == "text")   return ExportFormat::COLORS_TEXT;
+    if (name == "binary") return ExportFormat::COLORS_BINARY;
+    if (name == "dimacs") return ExportFormat::DIMACS;
+    if (name == "edges")  return ExportFormat::EDGE_LIST;
+    throw std::invalid_argument("Unknown export format: " + name);
+}
+
+const char* export_extension(ExportFormat format) {
+    switch (format) {
+        case ExportFormat::DOT:           return ".dot";
+        case ExportFormat::COLORS_TEXT:   return ".colors";
+        case ExportFormat::COLORS_BINARY: return ".colors.bin";
+        case ExportFormat::DIMACS:        return ".cnf";
+        case ExportFormat::EDGE_LIST:     return ".edges";
+        case ExportFormat::NONE:          break;
+    }
+    return "";
+}
+
+static void write_dot(const Graph& g, BufferedWriter& out) {
+    out.write("graph G {\n");
+    // One pass: each vertex line is followed by its edges to higher ids
     for (int i = 0; i < g.num_vertices(); ++i) {
         const Vertex& v = g.vertex(i);
         const char* color_str = "white";
@@ -33,17 +127,133 @@ void export_to_dot(const Graph& g, const std::string& path) {
             case YELLOW: color_str = "yellow"; break;
             case UNCOLORED: color_str = "gray"; break;
         }
-        out << "  " << v.id << " [style=filled, fillcolor=" << color_str << "];\n";
+        out.write("  ");
+        out.write_int(v.id);
+        out.write(" [style=filled, fillcolor=");
+        out.write(color_str);
+        out.write("];\n");
+
+        g.for_each_neighbor(v.id, [&](int w) {
+            if (w > v.id) {
+                out.write("  ");
+                out.write_int(v.id);
+                out.write(" -- ", 4);
+                out.write_int(w);
+                out.write(";\n", 2);
+            }
+            return true;
+        });
     }
+    out.write("}\n");
+}
+
+static void write_coloring_text(const Graph& g, BufferedWriter& out) {
     for (int i = 0; i < g.num_vertices(); ++i) {
-        const Vertex& v = g.vertex(i);
-        for (Neighbor* p = v.neighbors_head; p != nullptr; p = p->next) {
-            if (p->v->id > v.id) {
-                out << "  " << v.id << " -- " << p->v->id << ";\n";
+        out.write_int(g.vertex(i).color);
+        out.put('\n');
+    }
+}
+
+static void write_coloring_binary(const Graph& g, BufferedWriter& out) {
+    for (int i = 0; i < g.num_vertices(); ++i) {
+        Color c = g.vertex(i).color;
+        out.put(static_cast<char>(c == UNCOLORED ? 0xFF : c));
+    }
+}
+
+// Per vertex: at least one color, at most one color; per edge: not both the same color
+static void write_dimacs(const Graph& g, BufferedWriter& out) {
+    int n = g.num_vertices();
+    uint64_t edges = 0;
+    for (int i = 0; i < n; ++i) {
+        g.for_each_neighbor(i, [&](int w) { if (w > i) ++edges; return true; });
+    }
+
+    out.write("p cnf ");
+    out.write_int(3 * static_cast<int64_t>(n));
+    out.put(' ');
+    out.write_int(4 * static_cast<int64_t>(n) + 3 * static_cast<int64_t>(edges));
+    out.put('\n');
+
+    for (int i = 0; i < n; ++i) {
+        int64_t x = 3 * static_cast<int64_t>(i) + 1;
+        out.write_int(x); out.put(' ');
+        out.write_int(x + 1); out.put(' ');
+        out.write_int(x + 2); out.write(" 0\n", 3);
+        for (int a = 0; a < 3; ++a) {
+            for (int b = a + 1; b < 3; ++b) {
+                out.write_int(-(x + a)); out.put(' ');
+                out.write_int(-(x + b)); out.write(" 0\n", 3);
             }
         }
     }
-    out << "}\n";
+
+    for (int i = 0; i < n; ++i) {
+        g.for_each_neighbor(i, [&](int w) {
+            if (w <= i) return true;
+            int64_t x = 3 * static_cast<int64_t>(i) + 1;
+            int64_t y = 3 * static_cast<int64_t>(w) + 1;
+            for (int c = 0; c < 3; ++c) {
+                out.write_int(-(x + c)); out.put(' ');
+                out.write_int(-(y + c)); out.write(" 0\n", 3);
+            }
+            return true;
+        });
+    }
+}
+
+// Same format Graph::from_edge_list_file reads: "n m", then one "u v" line per edge
+static void write_edge_list(const Graph& g, BufferedWriter& out) {
+    int n = g.num_vertices();
+    uint64_t edges = 0;
+    for (int i = 0; i < n; ++i) {
+        g.for_each_neighbor(i, [&](int w) { if (w > i) ++edges; return true; });
+    }
+
+    out.write_int(n);
+    out.put(' ');
+    out.write_int(static_cast<int64_t>(edges));
+    out.put('\n');
+    for (int i = 0; i < n; ++i) {
+        g.for_each_neighbor(i, [&](int w) {
+            if (w > i) {
+                out.write_int(i);
+                out.put(' ');
+                out.write_int(w);
+                out.put('\n');
+            }
+            return true;
+        });
+    }
+}
+
+uint64_t export_graph(const Graph& g, const std::string& path, ExportFormat format, size_t chunk_size) {
+    if (format == ExportFormat::NONE) return 0;
+
+    BufferedWriter out(path, chunk_size);
+    switch (format) {
+        case ExportFormat::DOT:           write_dot(g, out); break;
+        case ExportFormat::COLORS_TEXT:   write_coloring_text(g, out); break;
+        case ExportFormat::COLORS_BINARY: write_coloring_binary(g, out); break;
+        case ExportFormat::DIMACS:        write_dimacs(g, out); break;
+        case ExportFormat::EDGE_LIST:     write_edge_list(g, out); break;
+        case ExportFormat::NONE:          break;
+    }
+    out.close();
+    return out.bytes_written();
+}
+
+// exports graphs to .dot file for visualization
+void export_to_dot(const Graph& g, const std::string& path) {
+    export_graph(g, path, ExportFormat::DOT);
+}
+
+void export_coloring_text(const Graph& g, const std::string& path) {
+    export_graph(g, path, ExportFormat::COLORS_TEXT);
+}
+
+void export_coloring_binary(const Graph& g, const std::string& path) {
+    export_graph(g, path, ExportFormat::COLORS_BINARY);
 }
 
 std::mt19937 make_rng() {
@@ -0,0 +1,78 @@
+/*
+verify.cpp
+
+Author: Dialo Sall
+
+Implementation of verify.hpp
+
+*/
+#include "verify.hpp"
+#include "parallel.hpp"
+#include <mutex>
+
+namespace threecolor {
+
+    VerifyReport verify_coloring_parallel(const Graph& g, int num_threads, bool stop_at_first) {
+        VerifyReport report{true, -1, -1, -1, 0, 0, 0, 0};
+        std::atomic<bool> violation(false);
+        std::mutex merge_mutex;
+
+        const int64_t chunk = 512;
+        parallel_for_chunks(0, g.num_vertices(), chunk, num_threads, [&](int64_t begin, int64_t end, int) {
+            int bad_vertex = -1, bad_u = -1, bad_v = -1;
+            int uncolored = 0, checked = 0;
+            uint64_t conflicts = 0, edges = 0;
+
+            for (int64_t i = begin; i < end; ++i) {
+                if (stop_at_first && violation.load(std::memory_order_relaxed)) break;
+
+                const Vertex& v = g.vertex(static_cast<int>(i));
+                ++checked;
+                if (v.color == UNCOLORED) {
+                    ++uncolored;
+                    if (bad_vertex < 0) bad_vertex = v.id;
+                    if (stop_at_first) {
+                        violation.store(true, std::memory_order_relaxed);
+                        break;
+                    }
+                    continue;
+                }
+
+                g.for_each_neighbor(v.id, [&](int id) {
+                    const Vertex& u = g.vertex(id);
+                    if (u.id < v.id) return true; // each edge once, from its lower endpoint
+                    ++edges;
+                    if (u.color == v.color) {
+                        ++conflicts;
+                        if (bad_u < 0) {
+                            bad_u = v.id;
+                            bad_v = u.id;
+                        }
+                        if (stop_at_first) return false;
+                    }
+                    return true;
+                });
+                if (stop_at_first && conflicts > 0) {
+                    violation.store(true, std::memory_order_relaxed);
+                    break;
+                }
+            }
+
+            // merge once per chunk
+            std::lock_guard<std::mutex> lock(merge_mutex);
+            report.uncolored_vertices += uncolored;
+            report.conflicting_edges += conflicts;
+            report.vertices_checked += checked;
+            report.edges_checked += edges;
+            if (report.bad_vertex < 0) report.bad_vertex = bad_vertex;
+            if (report.bad_u < 0 && bad_u >= 0) {
+                report.bad_u = bad_u;
+                report.bad_v = bad_v;
+            }
+        });
+
+        report.valid = report.uncolored_vertices == 0 && report.conflicting_edges == 0;
+        return report;
+    }
+
+} // namespace threecolor
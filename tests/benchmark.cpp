@@ -7,44 +7,1118 @@ Runs solve across multiple graph sizes and edge probabilities
 Tracks successes and records runtimes
 
 Basically trying to answer how the algorithm behaves as graph size/density increases
+
+Usage: bench [suite] [--checkpoint file] [--checkpoint-interval s] [--checkpoint-budget pct]
+    sweep (default)  success rate and runtime across n and p; with --checkpoint the
+                     progress is snapshotted (default every 30 s, at most 1% of the
+                     run) and an interrupted sweep resumes from the file
+    trace            cost of recording a step trace during run_greedy()
+    export           exporter throughput in MB/s
+    verify           verify_coloring_parallel scaling across thread counts
+    unsat            K4 / odd wheel filter against run_greedy on dense random graphs
+    dense            sparse vs. bitset engine across densities
+    policy           templated specializations vs. a copy of the pre-template run_greedy
+    propagation      forced-color propagation vs. the original trapped handling
+    csr              bulk CSR builder across thread counts vs. add_edge one edge at a time
+    parallel         round-based parallel greedy vs. run_greedy: rounds, speedup, success
+                     (uniform, power-law and 2M-vertex graphs)
+    cdcl             exact CDCL search vs. the greedy on planted and near-threshold graphs
+                     (set SAT_SOLVER, e.g. SAT_SOLVER=kissat, to also time an external
+                     solver on the DIMACS export)
+    compressed       bytes/edge and solve/verify time of compressed rows vs. Neighbor lists
+    external         streaming mode from an edge list file: sort runs, passes, bytes read/written
+    baselines        run_greedy vs. DSATUR and RLF: success rate, vertices/sec, solver memory
+    checkpoint       cost of CDCL snapshots at different budgets, and stop + resume vs. one run
+    all              every suite above
 */
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 #include "graph.hpp"
 #include "algorithm.hpp"
+#include "baseline_solvers.hpp"
+#include "cdcl_solver.hpp"
+#include "checkpoint.hpp"
+#include "csr_graph.hpp"
+#include "dense_solver.hpp"
+#include "external_coloring.hpp"
+#include "parallel_greedy.hpp"
+#include "sorting_machine.hpp"
+#include "trace.hpp"
 #include "utilities.hpp"
+#include "unsat_filter.hpp"
+#include "verify.hpp"
+#include "parallel.hpp"
 
 using namespace threecolor;
 
-int main() {
-    auto rng = make_rng();
+// With a checkpoint writer, progress is snapshotted between trials: the cell
+// and trial reached, the current cell's successes and time, the lines of the
+// finished cells and the RNG state. A snapshot left by an interrupted run is
+// picked up, so the rerun prints the same lines and draws the same graphs
+static void run_sweep_benchmark(std::mt19937& rng, CheckpointWriter* checkpoint) {
+    const std::vector<int> sizes = {20, 40, 60, 80, 100};
+    const std::vector<double> probabilities = {0.02, 0.05, 0.08, 0.1, 0.15, 0.2};
+    const size_t cells = sizes.size() * probabilities.size();
+    const int trials = 100;
+
+    size_t cell = 0;
+    int trial = 0, successes = 0;
+    int64_t us = 0;
+    std::vector<std::string> lines;
+
+    std::string snapshot;
+    if (checkpoint && load_checkpoint(checkpoint->path(), CheckpointKind::SWEEP, snapshot)) {
+        SnapshotReader in(snapshot);
+        cell = in.get<uint64_t>();
+        trial = in.get<int32_t>();
+        successes = in.get<int32_t>();
+        us = in.get<int64_t>();
+        std::istringstream state(in.get_string());
+        state >> rng;
+        lines.resize(in.get<uint64_t>());
+        for (std::string& line : lines) line = in.get_string();
+        if (cell >= cells || trial >= trials || !state) throw std::runtime_error("Damaged sweep checkpoint");
+        for (const std::string& line : lines) std::cout << line;
+        std::cout << "(resumed from " << checkpoint->path() << " at trial " << trial << ")\n";
+    }
+
+    auto save = [&] {
+        std::string& out = checkpoint->begin();
+        put_value<uint64_t>(out, cell);
+        put_value<int32_t>(out, trial);
+        put_value<int32_t>(out, successes);
+        put_value<int64_t>(out, us);
+        std::ostringstream state;
+        state << rng;
+        put_string(out, state.str());
+        put_value<uint64_t>(out, lines.size());
+        for (const std::string& line : lines) put_string(out, line);
+        checkpoint->commit(CheckpointKind::SWEEP);
+    };
+
+    for (; cell < cells; ++cell) {
+        int n = sizes[cell / probabilities.size()];
+        double p = probabilities[cell % probabilities.size()];
+
+        for (; trial < trials; ++trial) {
+            if (checkpoint && checkpoint->due()) save();
+
+            auto start = std::chrono::steady_clock::now();
+            Graph g = generate_random_graph(n, p, rng);
+            g.compute_degrees();
+
+            ThreeColorSolver solver(g);
+            if (solver.run_greedy() && solver.verify_coloring()) {
+                ++successes;
+            }
+            us += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+
+        std::ostringstream line;
+        line << "n=" << n << ", p=" << p
+             << " -> successes=" << successes << "/" << trials
+             << ", time=" << us << " us\n";
+        std::cout << line.str();
+        lines.push_back(line.str());
+        trial = 0;
+        successes = 0;
+        us = 0;
+    }
+
+    if (checkpoint) {
+        checkpoint->discard();
+        CheckpointStats cs = checkpoint->stats();
+        std::cout << "checkpoints: " << cs.snapshots << " written (last " << cs.last_bytes << " bytes), cost "
+                  << cs.overhead_percent << "% of " << cs.run_seconds << " s\n";
+    }
+}
 
-    for (int n : {20, 40, 60, 80, 100}) {
-        for (double p : {0.02, 0.05, 0.08, 0.1, 0.15, 0.2}) {
-            int trials = 100;
-            int successes = 0;
+// Same graphs solved with and without a tracer attached
+static void run_trace_benchmark(std::mt19937& rng) {
+    const char* trace_path = "bench_trace.bin";
 
+    for (int n : {1000, 5000, 10000}) {
+        // average degree around 2 so the greedy usually runs to completion
+        double p = 2.0 / n;
+        Graph g = generate_random_graph(n, p, rng);
+        int repeats = 10;
+
+        ThreeColorSolver solver(g);
+        long long plain_us = 0;
+        long long traced_us = 0;
+        uint64_t records = 0;
+
+        for (int r = 0; r < repeats; ++r) {
             auto start = std::chrono::steady_clock::now();
+            solver.run_greedy();
+            auto mid = std::chrono::steady_clock::now();
+
+            TraceRecorder tracer(trace_path, g.num_vertices());
+            solver.set_tracer(&tracer);
+            auto traced_start = std::chrono::steady_clock::now();
+            solver.run_greedy();
+            auto traced_end = std::chrono::steady_clock::now();
+            solver.set_tracer(nullptr);
+            tracer.close();
+            records += tracer.total_records();
+
+            plain_us += std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count();
+            traced_us += std::chrono::duration_cast<std::chrono::microseconds>(traced_end - traced_start).count();
+        }
+
+        double overhead = plain_us > 0 ? 100.0 * (traced_us - plain_us) / plain_us : 0.0;
+        std::cout << "trace n=" << n << " -> plain=" << plain_us << " us, traced=" << traced_us
+                  << " us, overhead=" << overhead << "%, records=" << records << "\n";
+    }
+    std::remove(trace_path);
+}
+
+// The original ofstream exporter, kept here as the baseline to beat
+static void export_to_dot_ofstream(const Graph& g, const std::string& path) {
+    std::ofstream out(path);
+    out << "graph G {\n";
+    for (int i = 0; i < g.num_vertices(); ++i) {
+        const Vertex& v = g.vertex(i);
+        const char* color_str = "white";
+        switch (v.color) {
+            case RED:    color_str = "red"; break;
+            case BLUE:   color_str = "blue"; break;
+            case YELLOW: color_str = "yellow"; break;
+            case UNCOLORED: color_str = "gray"; break;
+        }
+        out << "  " << v.id << " [style=filled, fillcolor=" << color_str << "];\n";
+    }
+    for (int i = 0; i < g.num_vertices(); ++i) {
+        const Vertex& v = g.vertex(i);
+        g.for_each_neighbor(v.id, [&](int w) {
+            if (w > v.id) {
+                out << "  " << v.id << " -- " << w << ";\n";
+            }
+            return true;
+        });
+    }
+    out << "}\n";
+}
+
+static void report_export(const char* label, uint64_t bytes, std::chrono::steady_clock::duration elapsed) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double mb = bytes / (1024.0 * 1024.0);
+    std::cout << "  " << label << ": " << mb << " MB in " << seconds * 1000.0 << " ms -> "
+              << (seconds > 0 ? mb / seconds : 0.0) << " MB/s\n";
+}
+
+static void run_export_benchmark(std::mt19937& rng) {
+    const std::string path = "bench_export.out";
+
+    for (int n : {2000, 5000}) {
+        Graph g = generate_random_graph(n, 0.1, rng);
+        ThreeColorSolver solver(g);
+        solver.run_greedy();
+        std::cout << "export n=" << n << ", p=0.1:\n";
+
+        auto start = std::chrono::steady_clock::now();
+        export_to_dot_ofstream(g, path);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        std::ifstream sized(path, std::ios::binary | std::ios::ate);
+        report_export("dot (ofstream)", static_cast<uint64_t>(sized.tellg()), elapsed);
+
+        const std::pair<const char*, ExportFormat> formats[] = {
+            {"dot (buffered)", ExportFormat::DOT},
+            {"colors text   ", ExportFormat::COLORS_TEXT},
+            {"colors binary ", ExportFormat::COLORS_BINARY},
+        };
+        for (const auto& f : formats) {
+            start = std::chrono::steady_clock::now();
+            uint64_t bytes = export_graph(g, path, f.second);
+            report_export(f.first, bytes, std::chrono::steady_clock::now() - start);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+// Verification cost on a valid coloring (full scan) for 1, 2, 4, ... threads
+static void run_verify_benchmark(std::mt19937& rng) {
+    for (int n : {5000, 10000}) {
+        // planted coloring so the scan is valid and touches every edge
+        std::vector<Color> planted;
+        Graph g = generate_planted_graph(n, 0.05, rng, &planted);
+        for (int i = 0; i < n; ++i) g.vertex(i).color = planted[i];
+        int repeats = 20;
+
+        std::cout << "verify n=" << n << ", p=0.05 (planted coloring):\n";
+        long long base_us = 0;
+        for (int threads = 1; threads <= default_thread_count() * 2; threads *= 2) {
+            VerifyReport report{};
+            auto start = std::chrono::steady_clock::now();
+            for (int r = 0; r < repeats; ++r) {
+                report = verify_coloring_parallel(g, threads, false);
+            }
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count() / repeats;
+            if (threads == 1) base_us = us;
+
+            std::cout << "  threads=" << threads << " -> " << us << " us, speedup="
+                      << (us > 0 ? static_cast<double>(base_us) / us : 0.0)
+                      << ", edges=" << report.edges_checked
+                      << ", conflicts=" << report.conflicting_edges
+                      << ", uncolored=" << report.uncolored_vertices << "\n";
+        }
+    }
+}
+
+// How often the filter certifies failure, and what it costs next to the greedy
+static void run_unsat_benchmark(std::mt19937& rng) {
+    for (int n : {100, 500, 2000}) {
+        for (double avg_degree : {3.0, 5.0, 10.0, 30.0}) {
+            double p = avg_degree / n;
+            int trials = 20;
+            int k4 = 0, wheels = 0, greedy_fail = 0;
+            long long filter_us = 0, greedy_us = 0;
 
             for (int t = 0; t < trials; ++t) {
                 Graph g = generate_random_graph(n, p, rng);
-                g.compute_degrees();
 
+                auto start = std::chrono::steady_clock::now();
+                UnsatWitness w = find_unsat_witness(g);
+                auto mid = std::chrono::steady_clock::now();
+                ThreeColorSolver solver(g);
+                bool ok = solver.run_greedy();
+                auto end = std::chrono::steady_clock::now();
+
+                if (w.kind == WitnessKind::K4) ++k4;
+                if (w.kind == WitnessKind::ODD_WHEEL) ++wheels;
+                if (!ok) ++greedy_fail;
+                filter_us += std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count();
+                greedy_us += std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count();
+            }
+
+            std::cout << "unsat n=" << n << ", avg_degree=" << avg_degree
+                      << " -> K4=" << k4 << ", odd wheel=" << wheels
+                      << ", greedy failures=" << greedy_fail << "/" << trials
+                      << ", filter=" << filter_us << " us, greedy=" << greedy_us << " us\n";
+        }
+    }
+}
+
+// Same graphs on both engines; bitset construction is reported separately
+// because it is paid once per graph, not once per solve
+static void run_dense_benchmark(std::mt19937& rng) {
+    for (int n : {500, 2000}) {
+        for (double p : {0.005, 0.02, 0.05, 0.2}) {
+            int trials = 5;
+            int sparse_ok = 0, dense_ok = 0;
+            long long sparse_us = 0, dense_us = 0, build_us = 0;
+
+            for (int t = 0; t < trials; ++t) {
+                // planted graphs keep the greedy running long enough to time
+                Graph g = generate_planted_graph(n, p, rng);
                 ThreeColorSolver solver(g);
-                if (solver.run_greedy() && solver.verify_coloring()) {
-                    ++successes;
+
+                auto start = std::chrono::steady_clock::now();
+                sparse_ok += solver.run_greedy();
+                auto built = std::chrono::steady_clock::now();
+                DenseSolver dense(g);
+                auto mid = std::chrono::steady_clock::now();
+                dense_ok += dense.run_greedy();
+                auto end = std::chrono::steady_clock::now();
+
+                sparse_us += std::chrono::duration_cast<std::chrono::microseconds>(built - start).count();
+                build_us += std::chrono::duration_cast<std::chrono::microseconds>(mid - built).count();
+                dense_us += std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count();
+            }
+
+            std::cout << "dense n=" << n << ", p=" << p
+                      << " -> sparse=" << sparse_us << " us (" << sparse_ok << "/" << trials << ")"
+                      << ", dense=" << dense_us << " us (" << dense_ok << "/" << trials << ")"
+                      << " + build=" << build_us << " us"
+                      << ", solve speedup=" << (dense_us > 0 ? static_cast<double>(sparse_us) / dense_us : 0.0)
+                      << "\n";
+        }
+    }
+}
+
+// The run_greedy from before the policy templates, kept here as the baseline
+// to beat: the trapped list is a singly linked stack (next_trapped, now a side
+// array since Vertex lost the field), the vertex order comes from the sorting
+// machine and colors are tried RED -> BLUE -> YELLOW. Tracing is left out
+class LegacyGreedySolver {
+public:
+    explicit LegacyGreedySolver(Graph& g) : graph_(g), trapped_head_(nullptr) {}
+
+    bool run_greedy() {
+        graph_.reset_coloring_state();
+        trapped_head_ = nullptr;
+        next_trapped_.assign(graph_.num_vertices(), nullptr);
+        machine_.initialize(graph_);
+
+        while (true) {
+            if (machine_.empty()) return true;
+
+            Vertex* v = pop_trapped();
+            if (v) {
+                machine_.remove(v);
+            } else {
+                v = machine_.pick_next_vertex();
+                if (!v) return true;
+                machine_.remove(v);
+            }
+
+            Color c = trapped_color(v);
+            if (c == UNCOLORED) c = choose_color_with_priority(v);
+            if (c == UNCOLORED) return false;
+
+            v->color = c;
+            if (!update_neighbors(v, c)) return false;
+        }
+    }
+
+private:
+    Graph& graph_;
+    SortingMachine machine_;
+    Vertex* trapped_head_;
+    std::vector<Vertex*> next_trapped_;
+
+    void add_trapped(Vertex* v) {
+        if (v->is_trapped) return;
+        v->is_trapped = true;
+        next_trapped_[v->id] = trapped_head_;
+        trapped_head_ = v;
+    }
+
+    // linear removal, as before the indexed trapped queue
+    void remove_trapped(Vertex* v) {
+        if (!v->is_trapped) return;
+        Vertex* prev = nullptr;
+        Vertex* cur = trapped_head_;
+        while (cur) {
+            if (cur == v) {
+                if (prev) next_trapped_[prev->id] = next_trapped_[cur->id];
+                else trapped_head_ = next_trapped_[cur->id];
+                break;
+            }
+            prev = cur;
+            cur = next_trapped_[cur->id];
+        }
+        v->is_trapped = false;
+        next_trapped_[v->id] = nullptr;
+    }
+
+    Vertex* pop_trapped() {
+        Vertex* v = trapped_head_;
+        while (v && v->color != UNCOLORED) {
+            trapped_head_ = next_trapped_[v->id];
+            v->is_trapped = false;
+            next_trapped_[v->id] = nullptr;
+            v = trapped_head_;
+        }
+        if (!v) return nullptr;
+
+        trapped_head_ = next_trapped_[v->id];
+        v->is_trapped = false;
+        next_trapped_[v->id] = nullptr;
+        return v;
+    }
+
+    static int available_color_count(const Vertex* v) {
+        uint8_t avail = static_cast<uint8_t>(~v->forbidden_mask) & 0b111;
+        int count = 0;
+        while (avail) {
+            count += (avail & 1);
+            avail >>= 1;
+        }
+        return count;
+    }
+
+    static Color trapped_color(const Vertex* v) {
+        uint8_t avail = static_cast<uint8_t>(~v->forbidden_mask) & 0b111;
+        int count = 0;
+        int last_color = -1;
+        for (int c = 0; c < 3; ++c) {
+            if ((avail >> c) & 1) {
+                ++count;
+                last_color = c;
+            }
+        }
+        return count == 1 ? static_cast<Color>(last_color) : UNCOLORED;
+    }
+
+    static Color choose_color_with_priority(const Vertex* v) {
+        uint8_t forb = v->forbidden_mask;
+        if ((forb & (1 << RED)) == 0)    return RED;
+        if ((forb & (1 << BLUE)) == 0)   return BLUE;
+        if ((forb & (1 << YELLOW)) == 0) return YELLOW;
+        return UNCOLORED;
+    }
+
+    bool update_neighbors(Vertex* v, Color c) {
+        for (Neighbor* p = v->neighbors_head; p != nullptr; p = p->next) {
+            Vertex* u = p->v;
+            if (u->color != UNCOLORED) continue;
+
+            uint8_t old_mask = u->forbidden_mask;
+            u->forbidden_mask = static_cast<uint8_t>(u->forbidden_mask | (1 << c));
+            if (u->forbidden_mask != old_mask) {
+                int avail_count = available_color_count(u);
+                if (avail_count == 0) return false;
+                if (avail_count == 1) add_trapped(u);
+                else if (u->is_trapped) remove_trapped(u);
+            }
+            machine_.bump_colored_neighbors(u);
+        }
+        return true;
+    }
+};
+
+// The pre-template run_greedy, then the default specialization called directly
+// and through the runtime dispatcher, then every other specialization on the
+// same graphs; ratio is the time against the pre-template run (below 1 is faster)
+static void run_policy_benchmark(std::mt19937& rng) {
+    const int n = 3000;
+    std::vector<Graph> graphs;
+    for (int t = 0; t < 20; ++t) graphs.push_back(generate_planted_graph(n, 6.0 / n, rng));
+
+    long long baseline_us = 0;
+    auto time_run = [&](const char* label, auto solve_one) {
+        int successes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < 3; ++r) {
+            for (Graph& g : graphs) successes += solve_one(g);
+        }
+        long long us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (baseline_us == 0) baseline_us = us > 0 ? us : 1;
+        std::cout << "policy " << label << " -> successes=" << successes << "/" << 3 * graphs.size()
+                  << ", time=" << us << " us, ratio=" << static_cast<double>(us) / baseline_us << "\n";
+    };
+
+    time_run("pre-template run_greedy (baseline)", [](Graph& g) {
+        LegacyGreedySolver solver(g);
+        return solver.run_greedy();
+    });
+    time_run("ThreeColorSolver::run_greedy", [](Graph& g) {
+        ThreeColorSolver solver(g);
+        return solver.run_greedy();
+    });
+    for (const char* spec : {"rby,lower-id,trapped", "rby,higher-id,trapped", "rby,lower-id,no-trapped",
+                             "least-used", "most-used", "least-used,higher-id,no-trapped"}) {
+        PolicyConfig config = parse_policy(spec);
+        time_run(spec, [&](Graph& g) { return run_greedy_with_policy(g, config, Engine::SPARSE); });
+    }
+}
+
+// Near the 3-coloring threshold (average degree ~4.69) most greedy runs fail;
+// the question is how much earlier forced-color conflicts stop them
+static void run_propagation_benchmark(std::mt19937& rng) {
+    for (int n : {1000, 4000}) {
+        for (double avg_degree : {3.5, 4.0, 4.69}) {
+            std::vector<Graph> graphs;
+            for (int t = 0; t < 20; ++t) graphs.push_back(generate_random_graph(n, avg_degree / n, rng));
+
+            for (const char* spec : {"trapped", "forced"}) {
+                PolicyConfig config = parse_policy(spec);
+                uint64_t steps = 0, propagated = 0, early = 0;
+                int successes = 0;
+
+                auto start = std::chrono::steady_clock::now();
+                for (Graph& g : graphs) {
+                    GreedyStats stats{};
+                    successes += run_greedy_with_policy(g, config, Engine::SPARSE, nullptr, &stats);
+                    steps += stats.steps;
+                    propagated += stats.propagated;
+                    early += stats.forced_conflicts;
                 }
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+                std::cout << "propagation n=" << n << ", avg_degree=" << avg_degree << ", " << spec
+                          << " -> successes=" << successes << "/" << graphs.size()
+                          << ", steps=" << steps << ", propagated=" << propagated
+                          << ", forced conflicts=" << early << ", time=" << us << " us\n";
+            }
+        }
+    }
+}
+
+// Raw edge arrays with 5% repeated edges (half of them reversed) and a few
+// self-loops, the shape of real scraped edge lists
+static void run_csr_benchmark(std::mt19937& rng) {
+    std::vector<int> thread_counts = {1, 2, 4, 8};
+    if (default_thread_count() > 8) thread_counts.push_back(default_thread_count());
+
+    for (int64_t m : {1000000LL, 10000000LL}) {
+        const int n = static_cast<int>(m / 5);
+        std::uniform_int_distribution<int> pick(0, n - 1);
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        std::vector<Edge> edges;
+        edges.reserve(m);
+        while (static_cast<int64_t>(edges.size()) < m) {
+            double r = coin(rng);
+            if (r < 0.05 && !edges.empty()) {
+                Edge e = edges[std::uniform_int_distribution<size_t>(0, edges.size() - 1)(rng)];
+                edges.push_back(r < 0.025 ? e : Edge{e.v, e.u});
+            } else if (r < 0.051) {
+                int v = pick(rng);
+                edges.push_back(Edge{v, v});
+            } else {
+                edges.push_back(Edge{pick(rng), pick(rng)});
             }
+        }
+
+        std::cout << "csr n=" << n << ", m=" << m << "\n";
+        long long one_thread_us = 0;
+        for (int threads : thread_counts) {
+            CsrBuildStats stats;
+            auto start = std::chrono::steady_clock::now();
+            CsrGraph csr = CsrGraph::from_edges(n, edges, threads, &stats);
+            auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            if (threads == 1) one_thread_us = us;
+
+            std::cout << "    from_edges threads=" << threads << " -> " << us << " us ("
+                      << static_cast<double>(m) / std::max<long long>(1, us) << " M edges/s, speedup="
+                      << static_cast<double>(one_thread_us) / std::max<long long>(1, us) << "x)"
+                      << ", kept=" << csr.num_edges() << ", duplicates=" << stats.duplicate_edges
+                      << ", self-loops=" << stats.self_loops << "\n";
+        }
+        // after the CSR runs, so its freed nodes do not slow their allocations
+        auto start = std::chrono::steady_clock::now();
+        {
+            Graph g(n);
+            for (const Edge& e : edges) g.add_edge(e.u, e.v);
+            g.compute_degrees();
+        }
+        auto list_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        std::cout << "    add_edge one at a time (no dedup) -> " << list_us << " us\n";
+    }
+}
 
-            auto end = std::chrono::steady_clock::now();
-            auto us = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+// Times ParallelGreedySolver on copies of graphs; the CSR copy is timed
+// separately (build) from the rounds themselves (solve)
+// baseline_us > 0 adds the speedup over that time
+static long long report_parallel_runs(const std::vector<Graph>& graphs, bool speculative, int threads,
+                                      long long baseline_us) {
+    int ok = 0;
+    uint64_t rounds = 0, conflicts = 0;
+    long long build_us = 0, solve_us = 0;
+    for (const Graph& original : graphs) {
+        Graph g = original;
+        ParallelGreedyOptions options;
+        options.threads = threads;
+        options.speculative = speculative;
 
+        auto start = std::chrono::steady_clock::now();
+        ParallelGreedySolver solver(g, options);
+        auto built = std::chrono::steady_clock::now();
+        bool success = solver.run_greedy();
+        auto end = std::chrono::steady_clock::now();
 
-            std::cout << "n=" << n << ", p=" << p
-                      << " -> successes=" << successes << "/" << trials
-                      << ", time=" << us << " us\n";
+        if (success && !verify_coloring_parallel(g, threads).valid) {
+            std::cout << "parallel greedy produced an invalid coloring\n";
         }
+        ok += success;
+        rounds += solver.stats().rounds;
+        conflicts += solver.stats().conflicts;
+        build_us += std::chrono::duration_cast<std::chrono::microseconds>(built - start).count();
+        solve_us += std::chrono::duration_cast<std::chrono::microseconds>(end - built).count();
+    }
+
+    std::cout << "    " << (speculative ? "speculative" : "jones-plassmann") << " threads=" << threads
+              << " -> successes=" << ok << "/" << graphs.size() << ", rounds=" << rounds / graphs.size()
+              << ", conflicts=" << conflicts << ", solve=" << solve_us << " us + build=" << build_us << " us";
+    if (baseline_us > 0) {
+        std::cout << ", speedup=" << static_cast<double>(baseline_us) / std::max(1LL, solve_us) << "x";
+    }
+    std::cout << "\n";
+    return solve_us;
+}
+
+// Parallel rounds against run_greedy on the same planted graphs, then graphs
+// too big for run_greedy (its cost grows faster than linearly) where the
+// speedup is measured against one thread
+// Planted power-law graph (Chung-Lu): endpoints drawn with weight (i + 1)^(-1 / (exponent - 1)),
+// so a few hubs reach degrees in the thousands; edges inside a hidden color class are dropped
+static Graph generate_power_law_planted_graph(int n, double avg_degree, double exponent, std::mt19937& rng) {
+    std::vector<double> weights(n);
+    for (int i = 0; i < n; ++i) weights[i] = std::pow(i + 1.0, -1.0 / (exponent - 1.0));
+    std::discrete_distribution<int> endpoint(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> color_dist(0, 2);
+    std::vector<int> hidden(n);
+    for (int& c : hidden) c = color_dist(rng);
+
+    std::vector<std::pair<int, int>> edges;
+    int64_t m = static_cast<int64_t>(n * avg_degree / 2);
+    for (int64_t i = 0; i < m; ++i) {
+        int u = endpoint(rng), v = endpoint(rng);
+        if (hidden[u] != hidden[v]) edges.push_back(std::minmax(u, v));
     }
+    // hubs draw the same pair many times; keep one copy of each
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    Graph g(n);
+    for (const auto& e : edges) g.add_edge(e.first, e.second);
+    g.compute_degrees();
+    return g;
+}
+
+static void run_parallel_benchmark(std::mt19937& rng) {
+    std::vector<int> thread_counts = {1, 2, 4, 8};
+    if (default_thread_count() > 8) thread_counts.push_back(default_thread_count());
+
+    for (double avg_degree : {2.0, 3.0, 4.0}) {
+        const int n = 30000;
+        std::vector<Graph> graphs;
+        for (int t = 0; t < 3; ++t) graphs.push_back(generate_sparse_planted_graph(n, avg_degree / n, rng));
+
+        int greedy_ok = 0;
+        long long greedy_us = 0;
+        for (const Graph& original : graphs) {
+            Graph g = original;
+            ThreeColorSolver solver(g);
+            auto start = std::chrono::steady_clock::now();
+            greedy_ok += solver.run_greedy();
+            greedy_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+        std::cout << "parallel n=" << n << ", avg_degree=" << avg_degree << " run_greedy -> successes="
+                  << greedy_ok << "/" << graphs.size() << ", time=" << greedy_us << " us\n";
+
+        for (bool speculative : {false, true}) {
+            for (int threads : thread_counts) report_parallel_runs(graphs, speculative, threads, greedy_us);
+        }
+    }
+
+    // power law: the two-step local-max check is where hubs used to cost degree^2
+    const int skewed_n = 200000;
+    std::vector<Graph> skewed;
+    for (int t = 0; t < 2; ++t) skewed.push_back(generate_power_law_planted_graph(skewed_n, 3.0, 2.5, rng));
+    int max_degree = 0;
+    for (int v = 0; v < skewed_n; ++v) max_degree = std::max(max_degree, skewed[0].vertex(v).degree);
+    std::cout << "parallel n=" << skewed_n << ", power law 2.5, avg_degree<=3, max_degree=" << max_degree
+              << " (speedup vs. 1 thread)\n";
+    for (bool speculative : {false, true}) {
+        long long one_thread_us = 0;
+        for (int threads : thread_counts) {
+            long long us = report_parallel_runs(skewed, speculative, threads, one_thread_us);
+            if (threads == 1) one_thread_us = us;
+        }
+    }
+
+    const int big_n = 2000000;
+    std::vector<Graph> big;
+    for (int t = 0; t < 2; ++t) big.push_back(generate_sparse_planted_graph(big_n, 3.0 / big_n, rng));
+    std::cout << "parallel n=" << big_n << ", avg_degree=3 (speedup vs. 1 thread)\n";
+    for (bool speculative : {false, true}) {
+        long long one_thread_us = 0;
+        for (int threads : thread_counts) {
+            long long us = report_parallel_runs(big, speculative, threads, one_thread_us);
+            if (threads == 1) one_thread_us = us;
+        }
+    }
+}
+
+// Runs the solver command on a DIMACS file; SAT solvers exit with 10 (SAT) or 20 (UNSAT)
+static SolveStatus run_external_solver(const std::string& command, const std::string& cnf_path) {
+    std::string line = command + " " + cnf_path + " > /dev/null 2>&1";
+    int rc = std::system(line.c_str());
+    if (rc != -1 && WIFEXITED(rc)) {
+        if (WEXITSTATUS(rc) == 10) return SolveStatus::SATISFIABLE;
+        if (WEXITSTATUS(rc) == 20) return SolveStatus::UNSATISFIABLE;
+    }
+    return SolveStatus::UNKNOWN;
+}
+
+// Planted graphs are always SAT; random graphs around average degree 4.69 are
+// split between SAT and UNSAT and are where the greedy fails most
+static void run_cdcl_benchmark(std::mt19937& rng) {
+    const char* external = std::getenv("SAT_SOLVER");
+    const std::string cnf_path = "bench_cdcl.cnf";
+
+    struct Family { const char* name; int n; double avg_degree; bool planted; };
+    for (const Family& f : {Family{"planted", 2000, 6.0, true}, Family{"planted", 2000, 4.69, true},
+                            Family{"random", 200, 4.2, false}, Family{"random", 200, 4.69, false},
+                            Family{"random", 400, 4.69, false}, Family{"random", 400, 5.2, false}}) {
+        std::vector<Graph> graphs;
+        for (int t = 0; t < 10; ++t) {
+            graphs.push_back(f.planted ? generate_planted_graph(f.n, f.avg_degree / f.n, rng)
+                                       : generate_random_graph(f.n, f.avg_degree / f.n, rng));
+            graphs.back().compute_degrees();
+        }
+
+        int greedy_ok = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (Graph& g : graphs) {
+            ThreeColorSolver solver(g);
+            greedy_ok += solver.run_greedy();
+        }
+        auto greedy_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        int sat = 0, unsat = 0, unknown = 0;
+        uint64_t conflicts = 0;
+        start = std::chrono::steady_clock::now();
+        for (Graph& g : graphs) {
+            CdclOptions options;
+            options.deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+            CdclSolver solver(g, options);
+            SolveStatus status = solver.solve();
+            if (status == SolveStatus::SATISFIABLE && !verify_coloring_parallel(g, 1).valid) {
+                std::cout << "cdcl produced an invalid coloring\n";
+            }
+            sat += status == SolveStatus::SATISFIABLE;
+            unsat += status == SolveStatus::UNSATISFIABLE;
+            unknown += status == SolveStatus::UNKNOWN;
+            conflicts += solver.stats().conflicts;
+        }
+        auto cdcl_us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "cdcl " << f.name << " n=" << f.n << ", avg_degree=" << f.avg_degree
+                  << " -> greedy successes=" << greedy_ok << "/" << graphs.size() << " (" << greedy_us << " us)"
+                  << ", cdcl sat=" << sat << " unsat=" << unsat << " unknown=" << unknown
+                  << ", conflicts=" << conflicts << ", time=" << cdcl_us << " us\n";
+
+        if (external) {
+            int ext_sat = 0, ext_unsat = 0, ext_unknown = 0;
+            start = std::chrono::steady_clock::now();
+            for (Graph& g : graphs) {
+                export_graph(g, cnf_path, ExportFormat::DIMACS);
+                SolveStatus status = run_external_solver(external, cnf_path);
+                ext_sat += status == SolveStatus::SATISFIABLE;
+                ext_unsat += status == SolveStatus::UNSATISFIABLE;
+                ext_unknown += status == SolveStatus::UNKNOWN;
+            }
+            auto ext_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            std::remove(cnf_path.c_str());
+            std::cout << "     " << external << " (export included) -> sat=" << ext_sat << " unsat=" << ext_unsat
+                      << " unknown=" << ext_unknown << ", time=" << ext_us << " us\n";
+        }
+    }
+}
+
+// Heap bytes in use (small chunks with their headers, plus mmapped blocks);
+// 0 where glibc's mallinfo2 is missing
+static uint64_t heap_in_use() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+static long long time_verify(const Graph& g, int reps) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) {
+        if (!verify_coloring_parallel(g, 1).valid) std::cout << "planted coloring rejected\n";
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+// Same planted graphs as Neighbor lists and as compressed rows: memory per
+// undirected edge, then verify (full pass over every row) and run_greedy times
+static void run_compressed_benchmark(std::mt19937& rng) {
+    for (int n : {30000, 2000000}) {
+        for (double avg_degree : {3.0, 6.0}) {
+            std::vector<Color> planted;
+            Graph plain = generate_sparse_planted_graph(n, avg_degree / n, rng, &planted);
+            uint64_t edges = 0;
+            for (int v = 0; v < n; ++v) edges += plain.vertex(v).degree;
+            edges /= 2;
+
+            const uint64_t vertex_bytes = static_cast<uint64_t>(n) * sizeof(Vertex);
+            uint64_t heap_before = heap_in_use();
+            Graph packed = plain;
+            uint64_t heap_lists = heap_in_use() - heap_before - vertex_bytes;
+            auto start = std::chrono::steady_clock::now();
+            packed.compress();
+            auto compress_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            uint64_t heap_packed = heap_in_use() - heap_before - vertex_bytes;
+
+            const double e = static_cast<double>(std::max<uint64_t>(1, edges));
+            std::cout << "compressed n=" << n << ", avg_degree=" << avg_degree << ", edges=" << edges << "\n";
+            std::cout << "    bytes/edge: lists=" << plain.adjacency_bytes() / e
+                      << " (heap " << heap_lists / e << "), compressed=" << packed.adjacency_bytes() / e
+                      << " (heap " << heap_packed / e << "), compress=" << compress_us << " us\n";
+
+            for (int v = 0; v < n; ++v) {
+                plain.vertex(v).color = planted[v];
+                packed.vertex(v).color = planted[v];
+            }
+            const int reps = n > 100000 ? 3 : 50;
+            long long list_verify = time_verify(plain, reps);
+            long long packed_verify = time_verify(packed, reps);
+            std::cout << "    verify x" << reps << ": lists=" << list_verify << " us, compressed="
+                      << packed_verify << " us (" << static_cast<double>(packed_verify) / std::max(1LL, list_verify)
+                      << "x)\n";
+
+            // run_greedy grows faster than linearly, so only on the small graphs
+            if (n > 100000) continue;
+            plain.reset_coloring_state();
+            packed.reset_coloring_state();
+            long long greedy_us[2];
+            bool ok[2];
+            Graph* graphs[2] = {&plain, &packed};
+            for (int i = 0; i < 2; ++i) {
+                ThreeColorSolver solver(*graphs[i]);
+                auto begin = std::chrono::steady_clock::now();
+                ok[i] = solver.run_greedy();
+                greedy_us[i] = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - begin).count();
+            }
+            std::cout << "    run_greedy: lists=" << greedy_us[0] << " us, compressed=" << greedy_us[1]
+                      << " us (" << static_cast<double>(greedy_us[1]) / std::max(1LL, greedy_us[0])
+                      << "x), same result=" << (ok[0] == ok[1] ? "yes" : "no") << "\n";
+        }
+    }
+}
+
+// Edge list file -> disk adjacency -> passes, against loading the same file into
+// memory; the 32 MB budget makes the bigger graphs sort in several runs
+static void run_external_benchmark(std::mt19937& rng) {
+    const std::string edges_path = "bench_external.edges";
+    const std::string adj_path = "bench_external.adj";
+    ExternalOptions options;
+    options.memory_bytes = 32ULL << 20;
+
+    for (int n : {200000, 2000000}) {
+        for (double avg_degree : {3.0, 4.0, 4.5}) {
+            {
+                Graph g = generate_sparse_planted_graph(n, avg_degree / n, rng);
+                export_graph(g, edges_path, ExportFormat::EDGE_LIST);
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            ExternalBuildStats build = build_external_adjacency(edges_path, adj_path, options);
+            auto built = std::chrono::steady_clock::now();
+            ExternalColorer colorer(adj_path, options);
+            bool ok = colorer.run();
+            auto colored = std::chrono::steady_clock::now();
+            bool valid = !ok || colorer.verify();
+            const ExternalColorStats& st = colorer.stats();
+
+            auto ms = [](std::chrono::steady_clock::duration d) {
+                return std::chrono::duration_cast<std::chrono::milliseconds>(d).count();
+            };
+            std::cout << "external n=" << n << ", avg_degree=" << avg_degree << ", edges=" << colorer.num_edges() << "\n";
+            std::cout << "    sort: " << build.sort_runs << " runs, read " << build.io.bytes_read / 1e6
+                      << " MB, wrote " << build.io.bytes_written / 1e6 << " MB, " << ms(built - start) << " ms\n";
+            std::cout << "    color: " << (ok ? "success" : "failure") << (valid ? "" : " (INVALID)") << " after "
+                      << st.passes << " passes, " << st.first_pass_conflicts << " conflicted after the first, read "
+                      << st.io.bytes_read / 1e6 << " MB, " << ms(colored - built) << " ms, state "
+                      << n * 11 / 1e6 << " MB\n";
+
+            // the same file loaded whole, for the memory it takes
+            uint64_t heap_before = heap_in_use();
+            start = std::chrono::steady_clock::now();
+            Graph loaded = Graph::from_edge_list_file(edges_path);
+            auto load_ms = ms(std::chrono::steady_clock::now() - start);
+            std::cout << "    in memory: load " << load_ms << " ms, graph " << (heap_in_use() - heap_before) / 1e6
+                      << " MB\n";
+        }
+    }
+    std::remove(edges_path.c_str());
+    std::remove(adj_path.c_str());
+}
+
+// One engine over the same graphs: successes, vertices per second, and the heap
+// the solver object holds once the run is over (its buckets, queues and
+// scratch arrays; the graph itself is allocated before and not counted)
+template <class Solver>
+static void report_baseline(const char* label, std::vector<Graph>& graphs) {
+    int successes = 0;
+    long long us = 0;
+    uint64_t vertices = 0, solver_bytes = 0;
+    for (Graph& g : graphs) {
+        uint64_t heap_before = heap_in_use();
+        Solver solver(g);
+        auto start = std::chrono::steady_clock::now();
+        bool ok = solver.run_greedy();
+        us += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        uint64_t heap_after = heap_in_use();
+        if (heap_after > heap_before) solver_bytes = std::max(solver_bytes, heap_after - heap_before);
+        if (ok && !verify_coloring_parallel(g, 1).valid) std::cout << "    " << label << " coloring INVALID\n";
+        successes += ok;
+        vertices += g.num_vertices();
+    }
+    std::cout << "    " << label << ": successes=" << successes << "/" << graphs.size() << ", "
+              << vertices / (std::max(1LL, us) / 1e6) / 1e6 << " M vertices/s, solver memory "
+              << static_cast<double>(solver_bytes) / graphs.front().num_vertices() << " B/vertex\n";
+}
+
+// The same planted graphs through each engine; run_greedy grows faster than
+// linearly, so the 2M-vertex graphs only go through DSATUR and RLF
+static void run_baselines_benchmark(std::mt19937& rng) {
+    for (int n : {30000, 2000000}) {
+        const std::vector<double> degrees = n > 100000 ? std::vector<double>{3.0, 4.5}
+                                                       : std::vector<double>{2.0, 3.0, 4.0, 4.5, 5.0};
+        for (double avg_degree : degrees) {
+            const int trials = n > 100000 ? 2 : 10;
+            std::vector<Graph> graphs;
+            for (int t = 0; t < trials; ++t) graphs.push_back(generate_sparse_planted_graph(n, avg_degree / n, rng));
+            std::cout << "baselines n=" << n << ", avg_degree=" << avg_degree << " (planted)\n";
+            if (n <= 100000) report_baseline<ThreeColorSolver>("run_greedy", graphs);
+            report_baseline<DsaturSolver>("DSATUR    ", graphs);
+            report_baseline<RlfSolver>("RLF       ", graphs);
+        }
+    }
+}
+
+// CDCL on hard random graphs near the threshold, without snapshots and with
+// snapshots at every restart the budget allows; then one search stopped
+// halfway and resumed from its snapshot, against the same search in one go
+static void run_checkpoint_benchmark(std::mt19937& rng) {
+    const std::string path = "bench_checkpoint.ckpt";
+    auto seconds_since = [](std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const int n = 600;
+    Graph g = generate_random_graph(n, 4.69 / n, rng);
+    g.compute_degrees();
+    const uint64_t limit = 60000;
+
+    double plain_seconds = 0;
+    struct Budget { const char* label; double percent; };
+    for (const Budget& budget : {Budget{"none", -1.0}, Budget{"1%", 1.0}, Budget{"5%", 5.0},
+                                 Budget{"every restart", 0.0}}) {
+        CdclOptions options;
+        options.max_conflicts = limit;
+        std::unique_ptr<CheckpointWriter> checkpoint;
+        if (budget.percent >= 0) {
+            CheckpointOptions checkpoint_options;
+            checkpoint_options.interval_seconds = 0.0;
+            checkpoint_options.max_overhead_percent = budget.percent;
+            checkpoint.reset(new CheckpointWriter(path, checkpoint_options));
+            options.checkpoint = checkpoint.get();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        CdclSolver solver(g, options);
+        SolveStatus status = solver.solve();
+        if (checkpoint) checkpoint->close();
+        double seconds = seconds_since(start);
+
+        std::cout << "checkpoint n=" << n << ", budget " << budget.label << ": " << solve_status_name(status)
+                  << " after " << solver.stats().conflicts << " conflicts, " << seconds << " s";
+        if (!checkpoint) {
+            plain_seconds = seconds;
+            std::cout << "\n";
+            continue;
+        }
+        CheckpointStats cs = checkpoint->stats();
+        checkpoint->discard();
+        std::cout << " (time " << (seconds >= plain_seconds ? "+" : "") << (seconds / plain_seconds - 1.0) * 100.0
+                  << "%)\n"
+                  << "    " << cs.snapshots << " snapshots, last " << cs.last_bytes / 1e6 << " MB, serialize "
+                  << cs.serialize_seconds * 1000 << " ms, write " << cs.write_seconds * 1000 << " ms, cost "
+                  << cs.overhead_percent << "% of the run\n";
+    }
+
+    // stop + resume: a smaller graph that the search finishes, but not right away
+    const int m = 350;
+    CdclOptions options;
+    options.max_conflicts = 1000000;
+    Graph h;
+    SolveStatus whole_status = SolveStatus::UNKNOWN;
+    uint64_t whole_conflicts = 0;
+    double whole_seconds = 0;
+    for (int attempt = 0; attempt < 20; ++attempt) {
+        h = generate_random_graph(m, 4.69 / m, rng);
+        h.compute_degrees();
+        auto start = std::chrono::steady_clock::now();
+        CdclSolver whole(h, options);
+        whole_status = whole.solve();
+        whole_seconds = seconds_since(start);
+        whole_conflicts = whole.stats().conflicts;
+        if (whole_status != SolveStatus::UNKNOWN && whole_conflicts >= 10000) break;
+    }
+    if (whole_status == SolveStatus::UNKNOWN || whole_conflicts < 10000) {
+        std::cout << "checkpoint resume: no graph needed between 10000 and " << options.max_conflicts
+                  << " conflicts\n";
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t first_conflicts;
+    {
+        CheckpointOptions checkpoint_options;
+        checkpoint_options.interval_seconds = 1e9; // only the final snapshot
+        CheckpointWriter checkpoint(path, checkpoint_options);
+        CdclOptions first_options;
+        first_options.max_conflicts = whole_conflicts / 2;
+        first_options.checkpoint = &checkpoint;
+        CdclSolver first(h, first_options);
+        first.solve();
+        first_conflicts = first.stats().conflicts;
+    }
+    std::string snapshot;
+    load_checkpoint(path, CheckpointKind::CDCL, snapshot);
+    CdclSolver resumed(h, options);
+    resumed.resume(snapshot);
+    SolveStatus resumed_status = resumed.solve();
+    double split_seconds = seconds_since(start);
+    std::remove(path.c_str());
+    if (resumed_status == SolveStatus::SATISFIABLE && !verify_coloring_parallel(h, 1).valid) {
+        std::cout << "resumed cdcl produced an invalid coloring\n";
+    }
+
+    std::cout << "checkpoint resume n=" << m << ": one run " << solve_status_name(whole_status) << " after "
+              << whole_conflicts << " conflicts, " << whole_seconds << " s; stopped at " << first_conflicts
+              << " and resumed: " << solve_status_name(resumed_status) << " after " << resumed.stats().conflicts
+              << " conflicts, " << split_seconds << " s (snapshot " << snapshot.size() / 1e6 << " MB)\n";
+}
+
+int main(int argc, char** argv) {
+    auto rng = make_rng();
+    std::string suite = argc > 1 ? argv[1] : "sweep";
+
+    std::string checkpoint_path;
+    CheckpointOptions checkpoint_options;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "--checkpoint") checkpoint_path = argv[i + 1];
+        else if (arg == "--checkpoint-interval") checkpoint_options.interval_seconds = std::stod(argv[i + 1]);
+        else if (arg == "--checkpoint-budget") checkpoint_options.max_overhead_percent = std::stod(argv[i + 1]);
+    }
+    std::unique_ptr<CheckpointWriter> checkpoint;
+    if (!checkpoint_path.empty()) checkpoint.reset(new CheckpointWriter(checkpoint_path, checkpoint_options));
+
+    if (suite == "sweep" || suite == "all") run_sweep_benchmark(rng, checkpoint.get());
+    if (suite == "trace" || suite == "all") run_trace_benchmark(rng);
+    if (suite == "export" || suite == "all") run_export_benchmark(rng);
+    if (suite == "verify" || suite == "all") run_verify_benchmark(rng);
+    if (suite == "unsat" || suite == "all") run_unsat_benchmark(rng);
+    if (suite == "dense" || suite == "all") run_dense_benchmark(rng);
+    if (suite == "policy" || suite == "all") run_policy_benchmark(rng);
+    if (suite == "propagation" || suite == "all") run_propagation_benchmark(rng);
+    if (suite == "csr" || suite == "all") run_csr_benchmark(rng);
+    if (suite == "parallel" || suite == "all") run_parallel_benchmark(rng);
+    if (suite == "cdcl" || suite == "all") run_cdcl_benchmark(rng);
+    if (suite == "compressed" || suite == "all") run_compressed_benchmark(rng);
+    if (suite == "external" || suite == "all") run_external_benchmark(rng);
+    if (suite == "baselines" || suite == "all") run_baselines_benchmark(rng);
+    if (suite == "checkpoint" || suite == "all") run_checkpoint_benchmark(rng);
 
     return 0;
 }
@@ -10,9 +10,35 @@ Has a success graph, fail graph, and random graph
 
 */
 #include <iostream>
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
 #include "graph.hpp"
 #include "algorithm.hpp"
+#include "baseline_solvers.hpp"
+#include "cdcl_solver.hpp"
+#include "checkpoint.hpp"
+#include "compressed_adjacency.hpp"
+#include "csr_graph.hpp"
+#include "dense_solver.hpp"
+#include "external_coloring.hpp"
+#include "parallel_greedy.hpp"
+#include "solve_service.hpp"
+#include "trace.hpp"
+#include "trapped_queue.hpp"
+#include "unsat_filter.hpp"
+#include "verify.hpp"
 #include "utilities.hpp"
 
 using namespace threecolor;
@@ -51,5 +77,938 @@ int main() {
         std::cout << "  Result: " << (ok ? "SUCCESS" : "FAILURE") << "\n";
     }
 
+    {
+        std::cout << "Policy test:\n";
+        auto rng = make_rng();
+        Graph g = generate_planted_graph(300, 0.02, rng);
+
+        // dispatcher with default config must match the plain solver
+        Graph direct = g;
+        Graph dispatched = g;
+        ThreeColorSolver solver(direct);
+        bool direct_ok = solver.run_greedy();
+        bool dispatched_ok = run_greedy_with_policy(dispatched, PolicyConfig(), Engine::SPARSE);
+        assert(direct_ok == dispatched_ok);
+        for (int i = 0; i < g.num_vertices(); ++i) {
+            assert(direct.vertex(i).color == dispatched.vertex(i).color);
+        }
+
+        // every specialization must either fail or produce a valid coloring
+        int variants = 0;
+        for (const char* spec : {"rby", "least-used", "most-used"}) {
+            for (const char* tie : {"lower-id", "higher-id"}) {
+                for (const char* trapped : {"trapped", "no-trapped", "forced"}) {
+                    PolicyConfig config = parse_policy(std::string(spec) + "," + tie + "," + trapped);
+                    Graph copy = g;
+                    if (run_greedy_with_policy(copy, config)) {
+                        assert(verify_coloring_parallel(copy, 1).valid);
+                    }
+                    Graph k4 = build_small_test_graph_2();
+                    bool k4_ok = run_greedy_with_policy(k4, config);
+                    assert(!k4_ok);
+                    ++variants;
+                }
+            }
+        }
+
+        // least-used spreads colors instead of preferring RED
+        PolicyConfig least = parse_policy("least-used");
+        assert(least.color == ColorRule::LEAST_USED && !least.higher_id_first &&
+               least.trapped == TrappedRule::FORCED);
+        Graph path(3);
+        path.add_edge(0, 1);
+        path.add_edge(1, 2);
+        path.compute_degrees();
+        bool path_ok = run_greedy_with_policy(path, least, Engine::SPARSE);
+        assert(path_ok);
+        // vertex 1 (degree 2) first gets RED; 0 then takes BLUE, 2 takes YELLOW
+        assert(path.vertex(1).color == RED && path.vertex(0).color == BLUE && path.vertex(2).color == YELLOW);
+        std::cout << "  Result: " << variants << " specializations checked\n";
+    }
+
+    {
+        std::cout << "Forced propagation test:\n";
+        // K4: after 0=RED and 1=BLUE, vertices 2 and 3 are both forced to YELLOW
+        GreedyStats plain{}, forced{};
+        Graph k4 = build_small_test_graph_2();
+        bool plain_ok = run_greedy_with_policy(k4, parse_policy("trapped"), Engine::SPARSE, nullptr, &plain);
+        bool forced_ok = run_greedy_with_policy(k4, parse_policy("forced"), Engine::SPARSE, nullptr, &forced);
+        assert(!plain_ok && !forced_ok);
+        assert(plain.steps == 3 && plain.forced_conflicts == 0);
+        assert(forced.steps == 2 && forced.forced_conflicts == 1);
+
+        auto rng = make_rng();
+        Graph g = generate_planted_graph(500, 0.01, rng);
+        GreedyStats stats{};
+        bool ok = run_greedy_with_policy(g, parse_policy("forced"), Engine::SPARSE, nullptr, &stats);
+        assert(stats.steps == stats.propagated + stats.machine_picks);
+        if (ok) {
+            assert(stats.steps == 500);
+            assert(verify_coloring_parallel(g, 1).valid);
+        }
+
+        // forced is the default, and it never changes the outcome: the same graphs
+        // succeed with the same colors as with the original trapped handling
+        GreedyStats defaults{};
+        Graph k4_default = build_small_test_graph_2();
+        bool default_ok = run_greedy_with_policy(k4_default, PolicyConfig(), Engine::SPARSE, nullptr, &defaults);
+        assert(!default_ok && defaults.steps == forced.steps);
+        int same_outcome = 0;
+        for (int t = 0; t < 40; ++t) {
+            Graph original = generate_random_graph(300, (3.0 + 0.05 * t) / 300, rng);
+            Graph strong = original;
+            bool original_ok = run_greedy_with_policy(original, parse_policy("trapped"), Engine::SPARSE);
+            bool strong_ok = run_greedy_with_policy(strong, PolicyConfig(), Engine::SPARSE);
+            assert(original_ok == strong_ok);
+            if (original_ok) {
+                for (int i = 0; i < original.num_vertices(); ++i) {
+                    assert(original.vertex(i).color == strong.vertex(i).color);
+                }
+            }
+            ++same_outcome;
+        }
+
+        TrappedQueue queue;
+        queue.reset(5);
+        queue.push_back(1);
+        queue.push_back(3);
+        queue.push_front(4);
+        queue.push_back(3); // already queued
+        assert(queue.size() == 3);
+        queue.remove(1);
+        assert(!queue.contains(1) && queue.contains(3));
+        int first = queue.pop_front();
+        int second = queue.pop_front();
+        int third = queue.pop_front();
+        assert(first == 4 && second == 3 && third == -1);
+        std::cout << "  Result: K4 rejected after " << forced.steps << " steps instead of " << plain.steps
+                  << ", " << same_outcome << " graphs with the same outcome\n";
+    }
+
+    {
+        std::cout << "Dense engine test:\n";
+        auto rng = make_rng();
+        int agreements = 0;
+        for (int n : {30, 64, 65, 200}) {
+            for (double p : {0.02, 0.05, 0.1, 0.3}) {
+                for (int planted = 0; planted < 2; ++planted) {
+                    Graph sparse_graph = planted ? generate_planted_graph(n, p, rng)
+                                                 : generate_random_graph(n, p, rng);
+                    Graph dense_graph = sparse_graph;
+                    Graph word_loop_graph = sparse_graph;
+
+                    ThreeColorSolver sparse(sparse_graph);
+                    ThreeColorSolver dense(dense_graph);
+                    bool sparse_ok = sparse.solve(Engine::SPARSE);
+                    bool dense_ok = dense.solve(Engine::DENSE);
+                    assert(sparse_ok == dense_ok);
+                    if (sparse_ok) {
+                        assert(dense.verify_coloring());
+                        for (int i = 0; i < n; ++i) {
+                            assert(sparse_graph.vertex(i).color == dense_graph.vertex(i).color);
+                        }
+                    }
+
+                    // the plain word loop, whatever the CPU runs by default
+                    DenseSolver word_loop(word_loop_graph);
+                    word_loop.use_avx2(false);
+                    assert(!word_loop.using_avx2());
+                    bool word_loop_ok = word_loop.run_greedy();
+                    assert(word_loop_ok == sparse_ok);
+                    for (int i = 0; i < n; ++i) {
+                        assert(word_loop_graph.vertex(i).color == dense_graph.vertex(i).color);
+                    }
+                    ++agreements;
+                }
+            }
+        }
+
+        Graph k4 = build_small_test_graph_2();
+        DenseSolver dense_k4(k4);
+        bool k4_ok = dense_k4.run_greedy();
+        assert(!k4_ok);
+        std::cout << "  Result: " << agreements << " graphs matched the sparse path, word loop and "
+                  << (DenseSolver::avx2_available() ? "AVX2" : "no AVX2 on this CPU") << "\n";
+    }
+
+    {
+        std::cout << "CSR builder test:\n";
+        // graph 1 with a repeated edge, a reversed copy and two self-loops
+        std::vector<Edge> edges = {{0, 1}, {0, 2}, {1, 2}, {1, 3}, {2, 3},
+                                   {0, 1}, {2, 1}, {3, 3}, {0, 0}, {3, 1}};
+        CsrBuildStats stats;
+        CsrGraph csr = CsrGraph::from_edges(4, edges, 4, &stats);
+        assert(csr.num_vertices() == 4 && csr.num_edges() == 5);
+        assert(stats.input_edges == 10 && stats.self_loops == 2 && stats.duplicate_edges == 3);
+        assert(csr.degree(0) == 2 && csr.degree(1) == 3 && csr.degree(2) == 3 && csr.degree(3) == 2);
+        for (int v = 0; v < 4; ++v) assert(std::is_sorted(csr.begin(v), csr.end(v)));
+
+        // neighbor lists come out in descending id order, as the dense engine expects
+        Graph g = csr.to_graph();
+        assert(g.vertex(1).degree == 3);
+        int previous = 4;
+        for (Neighbor* p = g.vertex(1).neighbors_head; p != nullptr; p = p->next) {
+            assert(p->v->id < previous);
+            previous = p->v->id;
+        }
+        ThreeColorSolver solver(g);
+        bool colored = solver.run_greedy();
+        assert(colored && solver.verify_coloring());
+
+        // same result on any thread count, and from_graph gives back the same rows
+        auto rng = make_rng();
+        Graph random = generate_random_graph(2000, 0.005, rng);
+        std::vector<Edge> random_edges;
+        for (int u = 0; u < random.num_vertices(); ++u) {
+            for (Neighbor* p = random.vertex(u).neighbors_head; p != nullptr; p = p->next) {
+                random_edges.push_back(Edge{u, p->v->id}); // both directions: every edge twice
+            }
+        }
+        CsrGraph one = CsrGraph::from_edges(2000, random_edges, 1);
+        CsrGraph many = CsrGraph::from_edges(2000, random_edges, 8);
+        CsrGraph copied = CsrGraph::from_graph(random, 3);
+        assert(one.offsets() == many.offsets() && one.targets() == many.targets());
+        assert(one.offsets() == copied.offsets() && one.targets() == copied.targets());
+        for (int v = 0; v < 2000; ++v) assert(one.degree(v) == random.vertex(v).degree);
+
+        bool threw = false;
+        try {
+            CsrGraph::from_edges(3, {{0, 3}});
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+
+        // the file loader drops the duplicates too
+        const char* path = "test_duplicates.txt";
+        {
+            std::ofstream out(path);
+            out << "4 7\n0 1\n0 2\n1 2\n1 3\n2 3\n1 0\n2 2\n";
+        }
+        Graph loaded = Graph::from_edge_list_file(path);
+        Graph loaded_packed = Graph::from_edge_list_file(path, true);
+        std::remove(path);
+        assert(loaded_packed.is_compressed() && loaded_packed.vertex(2).degree == 3);
+        assert(loaded.vertex(0).degree == 2 && loaded.vertex(2).degree == 3);
+        std::cout << "  Result: " << stats.duplicate_edges << " duplicates and "
+                  << stats.self_loops << " self-loops dropped\n";
+    }
+
+    {
+        std::cout << "Compressed adjacency test:\n";
+        // generated graphs already have descending lists, so the greedy makes the same choices
+        auto rng = make_rng();
+        int matched = 0;
+        for (int trial = 0; trial < 10; ++trial) {
+            Graph plain = generate_planted_graph(500, 0.01, rng);
+            Graph packed = plain;
+            packed.compress();
+            assert(packed.is_compressed() && !plain.is_compressed());
+            assert(packed.adjacency_bytes() < plain.adjacency_bytes());
+            for (int v = 0; v < 500; ++v) assert(packed.vertex(v).degree == plain.vertex(v).degree);
+
+            ThreeColorSolver a(plain);
+            ThreeColorSolver b(packed);
+            bool ok_a = a.run_greedy();
+            bool ok_b = b.run_greedy();
+            assert(ok_a == ok_b && a.stats().steps == b.stats().steps);
+            for (int v = 0; v < 500; ++v) assert(plain.vertex(v).color == packed.vertex(v).color);
+            if (ok_b) assert(verify_coloring_parallel(packed, 2).valid);
+            ++matched;
+        }
+
+        // duplicates are dropped; a copy keeps the compressed rows; new edges are refused
+        Graph dup(4);
+        dup.add_edge(0, 1); dup.add_edge(0, 2); dup.add_edge(1, 2); dup.add_edge(1, 3);
+        dup.add_edge(2, 3); dup.add_edge(1, 0);
+        dup.compress();
+        assert(dup.vertex(0).degree == 2 && dup.vertex(1).degree == 3);
+        Graph copy = dup;
+        assert(copy.is_compressed());
+        std::vector<int> row;
+        copy.for_each_neighbor(1, [&](int w) { row.push_back(w); return true; });
+        assert((row == std::vector<int>{3, 2, 0}));
+        ThreeColorSolver solver(copy);
+        bool colored = solver.run_greedy();
+        assert(colored && solver.verify_coloring());
+        bool threw = false;
+        try {
+            copy.add_edge(0, 3);
+        } catch (const std::logic_error&) {
+            threw = true;
+        }
+        assert(threw);
+
+        // gaps that need several varint bytes decode exactly; the walk stops when asked
+        CsrGraph wide = CsrGraph::from_edges(3000000, {{0, 5}, {0, 200}, {0, 70000}, {0, 2999999}});
+        CompressedAdjacency rows(wide.offsets(), wide.targets());
+        row.clear();
+        rows.for_each(0, [&](int w) { row.push_back(w); return true; });
+        assert((row == std::vector<int>{2999999, 70000, 200, 5}));
+        int seen = 0;
+        assert(!rows.for_each(0, [&](int) { return ++seen < 2; }) && seen == 2);
+        std::cout << "  Result: " << matched << " graphs colored identically\n";
+    }
+
+    {
+        std::cout << "External coloring test:\n";
+        const char* edges_path = "test_external.edges";
+        const char* adj_path = "test_external.adj";
+
+        // repeated edges and self-loops are dropped by the sort
+        {
+            std::ofstream out(edges_path);
+            out << "4 8\n0 1\n0 2\n1 2\n1 3\n2 3\n1 0\n2 2\n3 1\n";
+        }
+        ExternalBuildStats small = build_external_adjacency(edges_path, adj_path);
+        assert(small.input_edges == 8 && small.self_loops == 1 && small.duplicate_edges == 2);
+        ExternalColorer graph1(adj_path);
+        assert(graph1.num_vertices() == 4 && graph1.num_edges() == 5);
+        bool graph1_ok = graph1.run();
+        assert(graph1_ok && graph1.verify());
+        Graph g1 = build_small_test_graph_1();
+        for (int u = 0; u < 4; ++u) {
+            g1.for_each_neighbor(u, [&](int w) { assert(graph1.color(u) != graph1.color(w)); return true; });
+        }
+
+        // tiny budgets force many sort runs and a seek for every skipped row
+        auto rng = make_rng();
+        Graph planted = generate_planted_graph(3000, 3.5 / 3000, rng);
+        export_graph(planted, edges_path, ExportFormat::EDGE_LIST);
+        ExternalOptions options;
+        options.memory_bytes = 16 << 10;
+        options.read_chunk = 256;
+        ExternalBuildStats big = build_external_adjacency(edges_path, adj_path, options);
+        assert(big.sort_runs > 1 && big.duplicate_edges == 0 && big.io.bytes_written > 0);
+        ExternalColorer colorer(adj_path, options);
+        bool ok = colorer.run();
+        assert(colorer.stats().passes >= 1 && colorer.stats().io.bytes_read > 0);
+        if (ok) {
+            assert(colorer.verify());
+            for (int u = 0; u < 3000; ++u) {
+                planted.for_each_neighbor(u, [&](int w) { assert(colorer.color(u) != colorer.color(w)); return true; });
+            }
+        }
+
+        // K4 keeps a conflict through every repair pass
+        export_graph(build_small_test_graph_2(), edges_path, ExportFormat::EDGE_LIST);
+        build_external_adjacency(edges_path, adj_path);
+        options.max_passes = 5;
+        ExternalColorer k4(adj_path, options);
+        bool k4_ok = k4.run();
+        assert(!k4_ok && !k4.verify() && k4.stats().conflicted > 0 && k4.stats().passes == 6);
+
+        bool threw = false;
+        {
+            std::ofstream out(edges_path);
+            out << "3 1\n0 3\n";
+        }
+        try {
+            build_external_adjacency(edges_path, adj_path);
+        } catch (const std::out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+        std::remove(edges_path);
+        std::remove(adj_path);
+        std::cout << "  Result: " << (ok ? "SUCCESS" : "FAILURE") << " after " << colorer.stats().passes
+                  << " passes, " << big.sort_runs << " sort runs\n";
+    }
+
+    {
+        std::cout << "Solve service test:\n";
+        std::mutex mutex;
+        std::condition_variable answered;
+        std::map<uint64_t, SolveResponse> responses;
+        auto reply = [&](const SolveResponse& r) {
+            std::lock_guard<std::mutex> lock(mutex);
+            responses[r.id] = r;
+            answered.notify_all();
+        };
+        auto wait_for = [&](uint64_t id) {
+            std::unique_lock<std::mutex> lock(mutex);
+            answered.wait(lock, [&] { return responses.count(id) > 0; });
+            return responses[id];
+        };
+        std::set<uint64_t> started;
+        auto wait_started = [&](uint64_t id) {
+            std::unique_lock<std::mutex> lock(mutex);
+            answered.wait(lock, [&] { return started.count(id) > 0; });
+        };
+        auto edges_of = [](const Graph& g) {
+            std::vector<std::pair<int, int>> edges;
+            for (int u = 0; u < g.num_vertices(); ++u) {
+                g.for_each_neighbor(u, [&](int w) { if (w > u) edges.push_back(std::make_pair(u, w)); return true; });
+            }
+            return edges;
+        };
+
+        // frames survive a round trip
+        SolveRequest request;
+        request.id = 7;
+        request.solver = ServiceSolver::GREEDY;
+        request.deadline_ms = 250;
+        request.payload = encode_binary_graph(4, edges_of(build_small_test_graph_1()));
+        SolveRequest decoded;
+        bool decoded_ok = decode_request(encode_request(request), decoded);
+        assert(decoded_ok);
+        assert(decoded.id == 7 && decoded.solver == ServiceSolver::GREEDY && decoded.deadline_ms == 250);
+        assert(decoded.payload == request.payload);
+        decoded_ok = decode_request("short", decoded);
+        assert(!decoded_ok);
+
+        ServiceOptions options;
+        options.workers = 1;
+        options.on_start = [&](uint64_t id) {
+            std::lock_guard<std::mutex> lock(mutex);
+            started.insert(id);
+            answered.notify_all();
+        };
+        int owner = 0;
+        {
+            SolveService service(options);
+            service.submit(&owner, request, reply);
+            SolveResponse colored = wait_for(7);
+            assert(colored.status == ResponseStatus::COLORED && colored.data.size() == 4);
+            for (const auto& e : edges_of(build_small_test_graph_1())) {
+                assert(colored.data[e.first] != colored.data[e.second]);
+            }
+
+            SolveRequest k4;
+            k4.id = 8;
+            k4.format = PayloadFormat::EDGE_LIST;
+            k4.payload = "4 6\n0 1\n0 2\n0 3\n1 2\n1 3\n2 3\n";
+            service.submit(&owner, k4, reply);
+            assert(wait_for(8).status == ResponseStatus::NOT_COLORABLE);
+
+            SolveRequest bad = request;
+            bad.id = 9;
+            bad.payload.resize(bad.payload.size() - 3);
+            service.submit(&owner, bad, reply);
+            assert(wait_for(9).status == ResponseStatus::BAD_REQUEST);
+
+            // a fixed random graph well above degree 4.7: no K4 or odd wheel, and
+            // proving it uncolorable would take CDCL far longer than any deadline here
+            std::mt19937 rng(12345);
+            SolveRequest hard;
+            hard.solver = ServiceSolver::CDCL;
+            hard.payload = encode_binary_graph(3000, edges_of(generate_random_graph(3000, 5.0 / 3000, rng)));
+            hard.id = 10;
+            hard.deadline_ms = 20;
+            service.submit(&owner, hard, reply);
+            assert(wait_for(10).status == ResponseStatus::TIMEOUT);
+
+            // a greedy request whose deadline passes while its graph is parsed
+            // times out there instead of running the filter and the greedy
+            SolveRequest late;
+            late.solver = ServiceSolver::GREEDY;
+            late.payload = encode_binary_graph(400000, edges_of(generate_sparse_planted_graph(400000, 4.0 / 400000, rng)));
+            late.id = 13;
+            late.deadline_ms = 5;
+            service.submit(&owner, late, reply);
+            SolveResponse late_response = wait_for(13);
+            assert(late_response.status == ResponseStatus::TIMEOUT);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                assert(started.count(13) == 1 && late_response.solve_us > 0);
+            }
+
+            // cancel a running request and one still queued behind it
+            hard.deadline_ms = 0;
+            hard.id = 11;
+            service.submit(&owner, hard, reply);
+            hard.id = 12;
+            service.submit(&owner, hard, reply);
+            bool cancelled = service.cancel(&owner, 12);
+            assert(cancelled);
+            assert(wait_for(12).status == ResponseStatus::CANCELLED && wait_for(12).solve_us == 0);
+            wait_started(11);
+            cancelled = service.cancel(&owner, 11);
+            assert(cancelled);
+            assert(wait_for(11).status == ResponseStatus::CANCELLED);
+            cancelled = service.cancel(&owner, 11);
+            assert(!cancelled);
+        }
+
+        // the same over a stream: one solve, then shutdown
+        int fds[2];
+        int paired = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        assert(paired == 0);
+        bool shutdown_seen = false;
+        std::thread server([&] {
+            SolveService service(options);
+            shutdown_seen = serve_stream(service, fds[1], fds[1]);
+        });
+        request.format = PayloadFormat::EDGE_LIST;
+        request.payload = "4 5\n0 1\n0 2\n1 2\n1 3\n2 3\n";
+        SolveRequest stop;
+        stop.type = RequestType::SHUTDOWN;
+        bool sent = write_frame(fds[0], encode_request(request));
+        sent = write_frame(fds[0], encode_request(stop)) && sent;
+        assert(sent);
+        std::string body;
+        SolveResponse streamed;
+        bool received = read_frame(fds[0], body) && decode_response(body, streamed);
+        assert(received);
+        server.join();
+        close(fds[0]);
+        close(fds[1]);
+        assert(shutdown_seen && streamed.id == 7 && streamed.status == ResponseStatus::COLORED);
+        std::cout << "  Result: " << responses.size() << " requests answered, "
+                  << response_status_name(responses[10].status) << " at the 20 ms deadline\n";
+    }
+
+    {
+        std::cout << "Baseline solvers test:\n";
+        Graph g1 = build_small_test_graph_1();
+        DsaturSolver dsatur(g1);
+        bool dsatur_g1 = dsatur.run_greedy();
+        assert(dsatur_g1);
+        assert(verify_coloring_parallel(g1, 1).valid);
+        RlfSolver rlf(g1);
+        bool rlf_g1 = rlf.run_greedy();
+        assert(rlf_g1);
+        assert(verify_coloring_parallel(g1, 1).valid);
+
+        Graph k4 = build_small_test_graph_2();
+        DsaturSolver k4_dsatur(k4);
+        bool dsatur_k4 = k4_dsatur.run_greedy();
+        assert(!dsatur_k4);
+        assert(k4_dsatur.stats().contradiction >= 0);
+        RlfSolver k4_rlf(k4);
+        bool rlf_k4 = k4_rlf.run_greedy();
+        assert(!rlf_k4);
+        assert(k4_rlf.stats().uncolored == 1 && k4_rlf.stats().contradiction >= 0);
+
+        // DSATUR is exact on bipartite graphs: two colors, never YELLOW
+        auto rng = make_rng();
+        for (int t = 0; t < 5; ++t) {
+            const int n = 2000;
+            Graph bipartite(n);
+            std::uniform_int_distribution<int> side(0, n / 2 - 1);
+            for (int e = 0; e < 3 * n; ++e) bipartite.add_edge(2 * side(rng), 2 * side(rng) + 1);
+            bipartite.compute_degrees();
+            DsaturSolver solver(bipartite);
+            bool colored = solver.run_greedy();
+            assert(colored);
+            for (int i = 0; i < n; ++i) assert(bipartite.vertex(i).color != YELLOW);
+        }
+
+        // any success is valid, and compressed rows give the same colors as the lists
+        int dsatur_ok = 0, rlf_ok = 0;
+        for (int t = 0; t < 6; ++t) {
+            Graph g = generate_planted_graph(3000, (2.5 + 0.4 * t) / 3000, rng);
+            Graph packed = g;
+            packed.compress();
+            for (int engine = 0; engine < 2; ++engine) {
+                bool ok, packed_ok;
+                BaselineStats st;
+                if (engine == 0) {
+                    DsaturSolver a(g), b(packed);
+                    ok = a.run_greedy();
+                    packed_ok = b.run_greedy();
+                    st = a.stats();
+                    dsatur_ok += ok;
+                } else {
+                    RlfSolver a(g), b(packed);
+                    ok = a.run_greedy();
+                    packed_ok = b.run_greedy();
+                    st = a.stats();
+                    rlf_ok += ok;
+                }
+                assert(ok == packed_ok);
+                assert(verify_coloring_parallel(g, 1).valid == ok);
+                for (int i = 0; i < g.num_vertices(); ++i) assert(g.vertex(i).color == packed.vertex(i).color);
+                if (ok) assert(st.steps == 3000 && st.uncolored == 0 && st.contradiction == -1);
+                else assert(st.contradiction >= 0);
+            }
+        }
+        std::cout << "  Result: DSATUR colored " << dsatur_ok << " of 6, RLF " << rlf_ok << " of 6\n";
+    }
+
+    {
+        std::cout << "Parallel greedy test:\n";
+        Graph g1 = build_small_test_graph_1();
+        ParallelGreedySolver solver(g1);
+        bool g1_ok = solver.run_greedy();
+        assert(g1_ok);
+        assert(verify_coloring_parallel(g1).valid);
+
+        Graph k4 = build_small_test_graph_2();
+        ParallelGreedySolver k4_solver(k4);
+        bool k4_ok = k4_solver.run_greedy();
+        assert(!k4_ok);
+        assert(k4_solver.stats().contradiction >= 0);
+
+        // every mode gives the same coloring on 1 and 4 threads, and any success is valid
+        auto rng = make_rng();
+        int successes = 0;
+        uint64_t conflicts = 0;
+        for (int t = 0; t < 6; ++t) {
+            Graph g = generate_planted_graph(3000, 2.0 / 3000, rng);
+            for (bool speculative : {false, true}) {
+                for (ParallelPriority priority : {ParallelPriority::DEGREE, ParallelPriority::RANDOM}) {
+                    ParallelGreedyOptions options;
+                    options.speculative = speculative;
+                    options.priority = priority;
+                    options.threads = 1;
+                    ParallelGreedySolver one(g, options);
+                    bool ok = one.run_greedy();
+                    std::vector<Color> first;
+                    for (int i = 0; i < g.num_vertices(); ++i) first.push_back(g.vertex(i).color);
+
+                    options.threads = 4;
+                    ParallelGreedySolver four(g, options);
+                    bool four_ok = four.run_greedy();
+                    assert(four_ok == ok);
+                    assert(four.stats().rounds == one.stats().rounds);
+                    for (int i = 0; i < g.num_vertices(); ++i) assert(g.vertex(i).color == first[i]);
+
+                    assert(verify_coloring_parallel(g).valid == ok);
+                    if (ok) assert(four.stats().colored == 3000 && four.stats().contradiction == -1);
+                    if (!speculative) assert(four.stats().conflicts == 0);
+                    successes += ok;
+                    conflicts += four.stats().conflicts;
+                }
+            }
+        }
+        std::cout << "  Result: " << successes << " of 24 runs colored, "
+                  << conflicts << " speculative conflicts resolved\n";
+    }
+
+    {
+        std::cout << "Unsat filter test:\n";
+        Graph colorable = build_small_test_graph_1();
+        assert(!find_unsat_witness(colorable).found());
+
+        Graph k4 = build_small_test_graph_2();
+        UnsatWitness k4_witness = find_unsat_witness(k4);
+        assert(k4_witness.kind == WitnessKind::K4);
+        assert(k4_witness.edges.size() == 6);
+        assert(witness_is_valid(k4, k4_witness));
+
+        // 5-wheel: hub 0 joined to the 5-cycle 1-2-3-4-5, no K4 inside
+        Graph wheel(6);
+        for (int i = 1; i <= 5; ++i) {
+            wheel.add_edge(0, i);
+            wheel.add_edge(i, i == 5 ? 1 : i + 1);
+        }
+        wheel.compute_degrees();
+        UnsatWitness wheel_witness = find_unsat_witness(wheel);
+        assert(wheel_witness.kind == WitnessKind::ODD_WHEEL);
+        assert(wheel_witness.vertices.size() == 6 && wheel_witness.vertices[0] == 0);
+        assert(wheel_witness.edges.size() == 10);
+        assert(witness_is_valid(wheel, wheel_witness));
+
+        // a 3-colorable graph can never produce a witness
+        auto rng = make_rng();
+        Graph planted = generate_planted_graph(150, 0.2, rng);
+        assert(!find_unsat_witness(planted).found());
+
+        // the K4 search gives up after its work limit: ten 5-wheels keep it busy
+        // before it reaches the K4 on the last four vertices
+        Graph late(64);
+        for (int c = 0; c < 10; ++c) {
+            for (int i = 1; i <= 5; ++i) {
+                late.add_edge(6 * c, 6 * c + i);
+                late.add_edge(6 * c + i, 6 * c + (i == 5 ? 1 : i + 1));
+            }
+        }
+        for (int a = 60; a < 64; ++a) {
+            for (int b = a + 1; b < 64; ++b) late.add_edge(a, b);
+        }
+        late.compute_degrees();
+        UnsatFilterOptions k4_only;
+        k4_only.find_odd_wheels = false;
+        assert(find_unsat_witness(late, k4_only).kind == WitnessKind::K4);
+        k4_only.k4_work_limit = 1;
+        assert(!find_unsat_witness(late, k4_only).found());
+
+        // witnesses whose edges exist but whose shape is wrong are rejected
+        UnsatWitness even_rim = wheel_witness;
+        even_rim.vertices.pop_back();
+        assert(!witness_is_valid(wheel, even_rim));
+        UnsatWitness open_rim{WitnessKind::ODD_WHEEL, {0, 1, 2, 3}, {{0, 1}, {0, 2}, {0, 3}, {1, 2}, {2, 3}}};
+        assert(!witness_is_valid(wheel, open_rim));
+        UnsatWitness repeated{WitnessKind::K4, {0, 1, 2, 2}, {{0, 1}, {0, 2}, {1, 2}}};
+        assert(!witness_is_valid(k4, repeated));
+        UnsatWitness triangle{WitnessKind::K4, {0, 1, 2, 3}, {{0, 1}, {1, 2}, {0, 2}}};
+        assert(!witness_is_valid(wheel, triangle));
+        std::cout << "  Result: " << witness_kind_name(k4_witness.kind) << " and "
+                  << witness_kind_name(wheel_witness.kind) << " found\n";
+    }
+
+    {
+        std::cout << "Verify report test:\n";
+        Graph g = build_small_test_graph_1();
+        ThreeColorSolver solver(g);
+        bool ok = solver.run_greedy();
+        assert(ok);
+        VerifyReport good = verify_coloring_parallel(g, 4);
+        assert(good.valid && good.edges_checked == 5 && good.vertices_checked == 4);
+
+        // force edge 1-2 to clash and leave vertex 3 uncolored
+        g.vertex(2).color = g.vertex(1).color;
+        g.vertex(3).color = UNCOLORED;
+        VerifyReport bad = verify_coloring_parallel(g, 2, false);
+        assert(!bad.valid);
+        assert(bad.bad_u == 1 && bad.bad_v == 2);
+        assert(bad.bad_vertex == 3);
+        assert(bad.conflicting_edges == 1 && bad.uncolored_vertices == 1);
+        assert(!verify_coloring_parallel(g, 1).valid);
+        assert(!solver.verify_coloring());
+
+        auto rng = make_rng();
+        std::vector<Color> planted;
+        Graph planted_graph = generate_planted_graph(200, 0.1, rng, &planted);
+        for (int i = 0; i < planted_graph.num_vertices(); ++i) planted_graph.vertex(i).color = planted[i];
+        assert(verify_coloring_parallel(planted_graph, 3).valid);
+        std::cout << "  Result: edge " << bad.bad_u << "-" << bad.bad_v << " reported\n";
+    }
+
+    {
+        std::cout << "Export test:\n";
+        Graph g = build_small_test_graph_1();
+        ThreeColorSolver solver(g);
+        bool ok = solver.run_greedy();
+        assert(ok);
+
+        // tiny chunk size so every format crosses several flushes
+        uint64_t text_bytes = export_graph(g, "test_export.colors", ExportFormat::COLORS_TEXT, 4);
+        uint64_t bin_bytes = export_graph(g, "test_export.bin", ExportFormat::COLORS_BINARY, 4);
+        uint64_t dot_bytes = export_graph(g, "test_export.dot", ExportFormat::DOT, 4);
+        assert(export_graph(g, "unused", ExportFormat::NONE) == 0);
+        assert(bin_bytes == 4);
+        assert(text_bytes == 8);
+        assert(dot_bytes > 0);
+
+        std::ifstream text("test_export.colors");
+        std::ifstream bin("test_export.bin", std::ios::binary);
+        for (int i = 0; i < g.num_vertices(); ++i) {
+            int c;
+            text >> c;
+            assert(c == g.vertex(i).color);
+            assert(bin.get() == g.vertex(i).color);
+        }
+
+        std::ifstream dot("test_export.dot");
+        std::string line;
+        int edges = 0;
+        while (std::getline(dot, line)) {
+            if (line.find(" -- ") != std::string::npos) ++edges;
+        }
+        assert(edges == 5);
+
+        std::remove("test_export.colors");
+        std::remove("test_export.bin");
+        std::remove("test_export.dot");
+        std::cout << "  Result: " << dot_bytes << " DOT bytes written\n";
+    }
+
+    {
+        std::cout << "CDCL test:\n";
+        Graph g1 = build_small_test_graph_1();
+        CdclSolver sat(g1);
+        SolveStatus g1_status = sat.solve();
+        assert(g1_status == SolveStatus::SATISFIABLE);
+        assert(verify_coloring_parallel(g1).valid);
+
+        Graph k4 = build_small_test_graph_2();
+        SolveStatus k4_status = CdclSolver(k4).solve();
+        assert(k4_status == SolveStatus::UNSATISFIABLE);
+
+        // the 5-wheel has no K4, so refuting it takes real search
+        Graph wheel(6);
+        for (int i = 1; i <= 5; ++i) {
+            wheel.add_edge(0, i);
+            wheel.add_edge(i, i == 5 ? 1 : i + 1);
+        }
+        wheel.compute_degrees();
+        CdclSolver wheel_solver(wheel);
+        SolveStatus wheel_status = wheel_solver.solve();
+        assert(wheel_status == SolveStatus::UNSATISFIABLE);
+        assert(wheel_solver.stats().conflicts > 0);
+
+        auto rng = make_rng();
+        Graph planted = generate_planted_graph(300, 0.03, rng);
+        SolveStatus planted_status = CdclSolver(planted).solve();
+        assert(planted_status == SolveStatus::SATISFIABLE);
+        assert(verify_coloring_parallel(planted).valid);
+
+        // agree with brute force on small random graphs
+        int unsat = 0;
+        for (int trial = 0; trial < 40; ++trial) {
+            int n = 9;
+            Graph g = generate_random_graph(n, 0.5, rng);
+            g.compute_degrees();
+
+            bool colorable = false;
+            std::vector<int> col(n, 0);
+            for (int code = 0; code < 19683 && !colorable; ++code) { // 3^9 assignments
+                for (int v = 0, c = code; v < n; ++v, c /= 3) col[v] = c % 3;
+                colorable = true;
+                for (int v = 0; v < n && colorable; ++v) {
+                    for (Neighbor* p = g.vertex(v).neighbors_head; p != nullptr; p = p->next) {
+                        if (col[v] == col[p->v->id]) { colorable = false; break; }
+                    }
+                }
+            }
+
+            SolveStatus status = CdclSolver(g).solve();
+            assert(status == (colorable ? SolveStatus::SATISFIABLE : SolveStatus::UNSATISFIABLE));
+            if (colorable) assert(verify_coloring_parallel(g).valid);
+            else ++unsat;
+        }
+
+        // conflict budget of 1 stops the wheel before it is refuted
+        CdclOptions limited;
+        limited.max_conflicts = 1;
+        SolveStatus limited_status = CdclSolver(wheel, limited).solve();
+        assert(limited_status == SolveStatus::UNKNOWN);
+
+        // DIMACS: 3 vars per vertex, 4 clauses per vertex + 3 per edge
+        export_graph(g1, "test_export.cnf", ExportFormat::DIMACS, 8);
+        std::ifstream cnf("test_export.cnf");
+        std::string header;
+        std::getline(cnf, header);
+        assert(header == "p cnf 12 31");
+        int clauses = 0;
+        std::string line;
+        while (std::getline(cnf, line)) ++clauses;
+        assert(clauses == 31);
+        std::remove("test_export.cnf");
+        std::cout << "  Result: " << unsat << " of 40 random graphs refuted, "
+                  << wheel_solver.stats().conflicts << " conflicts on the 5-wheel\n";
+    }
+
+    {
+        std::cout << "Checkpoint test:\n";
+        const std::string path = "test_checkpoint.ckpt";
+        std::remove(path.c_str());
+        std::string payload;
+        bool loaded = load_checkpoint(path, CheckpointKind::SWEEP, payload);
+        assert(!loaded);
+
+        CheckpointOptions every_time;
+        every_time.interval_seconds = 0.0;
+        every_time.max_overhead_percent = 0.0;
+        {
+            CheckpointWriter writer(path, every_time);
+            assert(writer.due());
+            std::string& out = writer.begin();
+            put_value<int32_t>(out, 42);
+            put_vector(out, std::vector<int>{1, 2, 3});
+            put_string(out, "sweep");
+            writer.commit(CheckpointKind::SWEEP);
+            writer.close();
+            assert(writer.stats().snapshots == 1 && writer.stats().failures == 0);
+        }
+        loaded = load_checkpoint(path, CheckpointKind::SWEEP, payload);
+        assert(loaded);
+        {
+            SnapshotReader in(payload);
+            int32_t value = in.get<int32_t>();
+            std::vector<int> values = in.get_vector<int>();
+            std::string name = in.get_string();
+            assert(value == 42 && values == std::vector<int>({1, 2, 3}) && name == "sweep");
+            assert(in.at_end());
+            bool truncated = false;
+            try { in.get<int32_t>(); } catch (const std::runtime_error&) { truncated = true; }
+            assert(truncated);
+        }
+
+        // another kind, or one flipped byte, is rejected
+        bool rejected = false;
+        try { load_checkpoint(path, CheckpointKind::CDCL, payload); } catch (const std::runtime_error&) { rejected = true; }
+        assert(rejected);
+        {
+            std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(-1, std::ios::end);
+            file.put('x');
+        }
+        rejected = false;
+        try { load_checkpoint(path, CheckpointKind::SWEEP, payload); } catch (const std::runtime_error&) { rejected = true; }
+        assert(rejected);
+        std::remove(path.c_str());
+
+        // a search stopped halfway and resumed from its snapshot reaches the same answer
+        auto rng = make_rng();
+        int resumed_runs = 0;
+        for (int attempt = 0; attempt < 40 && resumed_runs < 3; ++attempt) {
+            Graph g = generate_random_graph(150, 4.69 / 150, rng);
+            g.compute_degrees();
+            CdclSolver whole(g);
+            SolveStatus expected = whole.solve();
+            uint64_t conflicts = whole.stats().conflicts;
+            if (conflicts < 50) continue;
+
+            {
+                CheckpointWriter writer(path, every_time);
+                CdclOptions options;
+                options.max_conflicts = conflicts / 2;
+                options.checkpoint = &writer;
+                CdclSolver first(g, options);
+                SolveStatus first_status = first.solve();
+                assert(first_status == SolveStatus::UNKNOWN);
+                writer.close();
+                assert(writer.stats().snapshots >= 1);
+            }
+            loaded = load_checkpoint(path, CheckpointKind::CDCL, payload);
+            assert(loaded);
+            CdclSolver resumed(g);
+            resumed.resume(payload);
+            assert(resumed.stats().conflicts == conflicts / 2);
+            SolveStatus resumed_status = resumed.solve();
+            assert(resumed_status == expected);
+            if (expected == SolveStatus::SATISFIABLE) assert(verify_coloring_parallel(g, 1).valid);
+
+            // the snapshot only fits its own graph
+            Graph other = build_small_test_graph_1();
+            CdclSolver wrong(other);
+            bool mismatch = false;
+            try { wrong.resume(payload); } catch (const std::runtime_error&) { mismatch = true; }
+            assert(mismatch);
+            ++resumed_runs;
+        }
+        std::remove(path.c_str());
+        std::cout << "  Result: " << resumed_runs << " searches resumed with the same answer\n";
+    }
+
+#if THREECOLOR_TRACE
+    {
+        std::cout << "Trace test:\n";
+        const char* path = "test_trace.bin";
+        Graph g = build_small_test_graph_2();
+        ThreeColorSolver solver(g);
+        TraceRecorder tracer(path, g.num_vertices(), 2); // tiny buffer forces hand-offs
+        solver.set_tracer(&tracer);
+        bool ok = solver.run_greedy();
+        tracer.close();
+
+        TraceHeader header;
+        std::vector<TraceRecord> records = read_trace(path, header);
+        std::remove(path);
+        assert(!ok);
+        assert(header.num_vertices == 4);
+        assert(records.size() == tracer.total_records());
+        assert(!records.empty() && records.back().contradiction == 1);
+        assert(records.front().source == SOURCE_MACHINE);
+
+        // a full disk is reported by close() instead of leaving a short trace
+        bool write_error = false;
+        {
+            TraceRecorder full("/dev/full", 4, 2);
+            for (int i = 0; i < 10000; ++i) full.record(records.front());
+            try {
+                full.close();
+            } catch (const std::runtime_error&) {
+                write_error = true;
+            }
+        }
+        assert(write_error);
+        std::cout << "  Result: " << records.size() << " steps recorded\n";
+    }
+#endif
+
     return 0;
 }